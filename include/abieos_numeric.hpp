@@ -1,29 +1,33 @@
 // copyright defined in abieos/LICENSE.txt
+#pragma once
 
 #include <algorithm>
 #include <array>
 #include <stdexcept>
 #include <stdint.h>
+#include <string.h>
 #include <string>
 #include <string_view>
 
 namespace abieos
 {
 
-const char base58_chars[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+inline constexpr char base58_chars[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
 
-bool map_initialized = false;
-std::array<int8_t, 256> base58_map{{0}};
-auto get_base58_map()
+// Built at compile time so the host SDK can decode keys from several threads
+constexpr std::array<int8_t, 256> create_base58_map()
+{
+    std::array<int8_t, 256> base58_map{{0}};
+    for (unsigned i = 0; i < base58_map.size(); ++i)
+        base58_map[i] = -1;
+    for (unsigned i = 0; i < sizeof(base58_chars) - 1; ++i)
+        base58_map[static_cast<unsigned char>(base58_chars[i])] = i;
+    return base58_map;
+}
+
+inline constexpr std::array<int8_t, 256> base58_map = create_base58_map();
+inline const std::array<int8_t, 256> &get_base58_map()
 {
-    if (!map_initialized)
-    {
-        for (unsigned i = 0; i < base58_map.size(); ++i)
-            base58_map[i] = -1;
-        for (unsigned i = 0; i < sizeof(base58_chars); ++i)
-            base58_map[base58_chars[i]] = i;
-        map_initialized = true;
-    }
     return base58_map;
 }
 
@@ -33,7 +37,7 @@ std::array<uint8_t, size> base58_to_binary(std::string_view s)
     std::array<uint8_t, size> result{{0}};
     for (auto &src_digit : s)
     {
-        int carry = get_base58_map()[src_digit];
+        int carry = get_base58_map()[static_cast<unsigned char>(src_digit)];
         if (carry < 0)
             eosio::check(0, "invalid base-58 value");
         for (auto &result_byte : result)
@@ -71,7 +75,7 @@ Key string_to_key(std::string_view s, key_type type, const char (&suffix)[suffix
     return result;
 }
 
-public_key string_to_public_key(std::string_view s)
+inline public_key string_to_public_key(std::string_view s)
 {
     if (s.size() >= 3 && s.substr(0, 3) == "EOS")
     {
@@ -88,6 +92,7 @@ public_key string_to_public_key(std::string_view s)
     else
     {
         eosio::check(0, "unrecognized public key format");
+        return {};
     }
 }
 
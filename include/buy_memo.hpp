@@ -0,0 +1,218 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include <stdint.h>
+#include <string_view>
+
+// Transfer memo grammar and custom account prices, shared by the contract and the host SDK
+namespace nameswaps
+{
+
+// Length of a public key in a transfer memo
+constexpr uint16_t KEY_LENGTH = 53;
+
+// Maximum length of a referrer in a transfer memo
+constexpr uint16_t REFERRER_LENGTH = 12;
+
+// Parts of an account purchase memo: <code><account>,<owner_key>,<active_key>[,<referrer>]
+struct buy_memo
+{
+    // Buy code (cn:, sp: or mk:)
+    std::string_view code;
+
+    // Name of account to buy
+    std::string_view account_name;
+
+    // Owner and active public keys
+    std::string_view owner_key;
+    std::string_view active_key;
+
+    // Referrer name (empty if none)
+    std::string_view referrer;
+};
+
+// Buy code of a transfer memo
+constexpr std::string_view buy_code(std::string_view memo)
+{
+    return memo.substr(0, 3);
+}
+
+// Is the buy code one the contract accepts?
+constexpr bool valid_buy_code(std::string_view code)
+{
+    return code == "cn:" || code == "sp:" || code == "mk:" || code == "wt:" || code == "bk:" || code == "cr:" || code == "rl:";
+}
+
+// Substring that is empty instead of out of range
+constexpr std::string_view memo_field(std::string_view memo, size_t pos, size_t count = std::string_view::npos)
+{
+    return pos > memo.size() ? std::string_view() : memo.substr(pos, count);
+}
+
+// Split a cn:, sp: or mk: memo. Returns the contract's error message, or nullptr if the memo is well formed
+constexpr const char *parse_buy_memo(std::string_view memo, buy_memo &parsed)
+{
+
+    parsed.code = buy_code(memo);
+    if (parsed.code != "cn:" && parsed.code != "sp:" && parsed.code != "mk:")
+    {
+        return "Buy Error: Malformed buy string.";
+    }
+
+    // Strip buy code from memo
+    const std::string_view memo2 = memo.substr(3);
+
+    // Find the length of the account name
+    size_t name_length = 0;
+    for (size_t lp = 1; lp <= 12 && lp < memo2.size(); ++lp)
+    {
+        if (memo2[lp] == ',')
+        {
+            name_length = lp;
+            break;
+        }
+    }
+
+    // Check the name length is valid
+    if (name_length == 0)
+    {
+        return "Buy Error: Malformed buy name.";
+    }
+
+    // Keys are at fixed offsets after the name
+    parsed.account_name = memo2.substr(0, name_length);
+    parsed.owner_key = memo_field(memo2, name_length + 1, KEY_LENGTH);
+    parsed.active_key = memo_field(memo2, name_length + 2 + KEY_LENGTH, KEY_LENGTH);
+
+    // Anything after the keys that fits a name is the referrer
+    const size_t referrer_pos = name_length + 3 + 2 * KEY_LENGTH;
+    parsed.referrer = std::string_view();
+    if (memo2.size() > referrer_pos && memo2.size() <= referrer_pos + REFERRER_LENGTH)
+    {
+        parsed.referrer = memo2.substr(referrer_pos);
+    }
+
+    return nullptr;
+}
+
+// Parts of a buy-and-relist memo: rl:<account>,<new sale price>[,<referrer>]
+struct relist_memo
+{
+    // Name of account to buy
+    std::string_view account_name;
+
+    // New sale price as a decimal amount of the network token (e.g. 25.5)
+    std::string_view saleprice;
+
+    // Referrer name (empty if none)
+    std::string_view referrer;
+};
+
+// Split an rl: memo. Returns the contract's error message, or nullptr if the memo is well formed
+constexpr const char *parse_relist_memo(std::string_view memo, relist_memo &parsed)
+{
+
+    if (buy_code(memo) != "rl:")
+    {
+        return "Buy Error: Malformed buy string.";
+    }
+
+    const std::string_view memo2 = memo.substr(3);
+    const size_t comma1 = memo2.find(',');
+    if (comma1 == 0 || comma1 > 12 || comma1 == std::string_view::npos)
+    {
+        return "Relist Error: Malformed relist name.";
+    }
+
+    const size_t comma2 = memo2.find(',', comma1 + 1);
+    parsed.account_name = memo2.substr(0, comma1);
+    parsed.saleprice = memo2.substr(comma1 + 1, comma2 == std::string_view::npos ? std::string_view::npos : comma2 - comma1 - 1);
+    parsed.referrer = comma2 == std::string_view::npos ? std::string_view() : memo2.substr(comma2 + 1);
+
+    if (parsed.saleprice.empty() || parsed.referrer.size() > REFERRER_LENGTH)
+    {
+        return "Relist Error: Malformed relist string.";
+    }
+
+    return nullptr;
+}
+
+// Decimal amount in a memo (e.g. 25.5) in units of 10^-precision. Returns false if it is malformed or too precise.
+// Also parses the prices in the SDK's watchlist and event files
+constexpr bool memo_amount(std::string_view str, unsigned precision, int64_t &amount)
+{
+
+    const size_t dot = str.find('.');
+    const size_t decimals = dot == std::string_view::npos ? 0 : str.size() - dot - 1;
+    if (str.empty() || dot == 0 || (decimals == 0 && dot != std::string_view::npos) || decimals > precision || precision > 18)
+    {
+        return false;
+    }
+
+    int64_t value = 0;
+    for (size_t i = 0; i < str.size(); ++i)
+    {
+        if (i == dot)
+        {
+            continue;
+        }
+        if (str[i] < '0' || str[i] > '9' || value > (INT64_MAX - 9) / 10)
+        {
+            return false;
+        }
+        value = value * 10 + (str[i] - '0');
+    }
+
+    for (size_t i = decimals; i < precision; ++i)
+    {
+        if (value > INT64_MAX / 10)
+        {
+            return false;
+        }
+        value *= 10;
+    }
+
+    amount = value;
+    return true;
+}
+
+// Is custom account creation offered for the suffix (e.g. ".x")?
+constexpr bool valid_custom_suffix(std::string_view suffix)
+{
+    return suffix == ".e" || suffix == ".x" || suffix == ".y" || suffix == ".z";
+}
+
+// Price of a custom account in the smallest token unit, or 0 if that name length is not offered
+constexpr int64_t custom_price(std::string_view suffix, int name_length)
+{
+
+    // Prices for name lengths 6 to 12
+    constexpr int64_t e_prices[] = {0, 57000, 47000, 37000, 27000, 17000, 8000};
+    constexpr int64_t x_prices[] = {0, 67000, 57000, 47000, 37000, 27000, 17000};
+    constexpr int64_t yz_prices[] = {507000, 57000, 47000, 37000, 27000, 17000, 8000};
+
+    if (name_length < 6 || name_length > 12)
+    {
+        return 0;
+    }
+
+    if (suffix == ".e")
+    {
+        return e_prices[name_length - 6];
+    }
+    else if (suffix == ".x")
+    {
+        return x_prices[name_length - 6];
+    }
+    else if (suffix == ".y" || suffix == ".z")
+    {
+        return yz_prices[name_length - 6];
+    }
+
+    return 0;
+}
+
+} // namespace nameswaps
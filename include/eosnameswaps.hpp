@@ -9,8 +9,10 @@
 #include <eosio/transaction.hpp>
 #include <eosio/crypto.hpp>
 #include <eosio/time.hpp>
+#include <eosio/singleton.hpp>
 
 #include "abieos_numeric.hpp"
+#include "buy_memo.hpp"
 
 namespace eosiosystem
 {
@@ -75,12 +77,103 @@ struct delegated_bandwidth
     uint64_t primary_key() const { return to.value; }
 };
 
+// Bancor connector of the system RAM market
+struct connector
+{
+    asset balance;
+    double weight;
+
+    EOSLIB_SERIALIZE(connector, (balance)(weight))
+};
+
+// Row of the eosio rammarket table
+struct exchange_state
+{
+    asset supply;
+    connector base;
+    connector quote;
+
+    uint64_t primary_key() const { return supply.symbol.raw(); }
+
+    EOSLIB_SERIALIZE(exchange_state, (supply)(base)(quote))
+};
+
+// Account to create in a bulk make_account request
+struct newaccountreq
+{
+    // Name of account to create
+    name account_name;
+
+    // Owner and active public keys
+    string owner_key;
+    string active_key;
+
+    EOSLIB_SERIALIZE(newaccountreq, (account_name)(owner_key)(active_key))
+};
+
+// Screening decision in a screenbatch request
+struct screenopt
+{
+    // Name of account being sold
+    name account4sale;
+
+    // Screening option (see screener)
+    uint8_t option;
+
+    EOSLIB_SERIALIZE(screenopt, (account4sale)(option))
+};
+
+// Settlement breakdown of a listed account (returned by the quote action)
+struct salequote
+{
+    // Name of account being sold
+    name account4sale;
+
+    // Price the buyer must transfer
+    asset saleprice;
+
+    // Amounts sent to the seller, contract and referrer
+    asset sellerfee;
+    asset contractfee;
+    asset referrerfee;
+
+    // Accounts receiving the seller and referrer fees
+    name paymentaccnt;
+    name ref_account;
+
+    // Transfer memo (replace the key placeholders)
+    string memo;
+
+    EOSLIB_SERIALIZE(salequote, (account4sale)(saleprice)(sellerfee)(contractfee)(referrerfee)(paymentaccnt)(ref_account)(memo))
+};
+
+// Rate limit of an action: a token bucket per calling account
+struct ratelimit
+{
+    // Rate limited action (vote, proposebid or reserve)
+    name action;
+
+    // Maximum number of calls in a burst (0 = unlimited)
+    uint8_t capacity;
+
+    // Seconds to refill one call
+    uint32_t refill_sec;
+
+    EOSLIB_SERIALIZE(ratelimit, (action)(capacity)(refill_sec))
+};
+
 class[[eosio::contract("eosnameswaps")]] eosnameswaps : public contract
 {
 
 public:
     // Transfer memo
-    const uint16_t KEY_LENGTH = 53;
+    const uint16_t KEY_LENGTH = nameswaps::KEY_LENGTH;
+
+    // Maximum number of accounts in a basket purchase
+    const uint16_t MAX_BASKET = 20;
+
+    // Maximum number of accounts in a bulk make_account request
+    const uint16_t MAX_BULK = 50;
 
     // Bid decision
     const uint16_t BID_REJECTED = 0;
@@ -94,7 +187,22 @@ public:
                                                                       _bids(_self, _self.value),
                                                                       _stats(_self, _self.value),
                                                                       _referrer(_self, _self.value),
-                                                                      _shops(_self, _self.value){}
+                                                                      _shops(_self, _self.value),
+                                                                      _categories(_self, _self.value),
+                                                                      _dutch(_self, _self.value),
+                                                                      _wanted(_self, _self.value),
+                                                                      _credits(_self, _self.value),
+                                                                      _config(_self, _self.value),
+                                                                      _screening(_self, _self.value),
+                                                                      _refstats(_self, _self.value),
+                                                                      _changes(_self, _self.value),
+                                                                      _tombstones(_self, _self.value),
+                                                                      _sync(_self, _self.value),
+                                                                      _trending(_self, _self.value),
+                                                                      _shopitems(_self, _self.value),
+                                                                      _reserves(_self, _self.value),
+                                                                      _salefeed(_self, _self.value),
+                                                                      _feedstate(_self, _self.value){}
                                                                           // ----------------
                                                                           // Contract Actions
                                                                           // ----------------
@@ -123,6 +231,23 @@ public:
                                   asset saleprice,
                                   string message);
 
+    // Set a declining (dutch auction) sale price
+    [[eosio::action]] void dutch(name account4sale,
+                                 asset startprice,
+                                 asset endprice,
+                                 uint32_t duration);
+
+    // Make accounts paid from the account creation credit
+    [[eosio::action]] void bulkmake(name from,
+                                    std::vector<newaccountreq> accounts);
+
+    // Withdraw unused account creation credit
+    [[eosio::action]] void withdraw(name from,
+                                    asset quantity);
+
+    // Cancel a wanted offer and refund it
+    [[eosio::action]] void cancelwant(uint64_t id);
+
     // Increment the vote count
     [[eosio::action]] void vote(name account4sale,
                                 name voter);
@@ -139,6 +264,16 @@ public:
                                    name payment2,
                                    name payment3);
 
+    // Set the seller fee split of a shop
+    [[eosio::action]] void setsplits(name shopname,
+                                     uint16_t split1,
+                                     uint16_t split2,
+                                     uint16_t split3);
+
+    // Put a listing in a shop (empty shopname takes it out)
+    [[eosio::action]] void setshop(name account4sale,
+                                   name shopname);
+
     // Propose a bid
     [[eosio::action]] void proposebid(name account4sale,
                                       asset bidprice,
@@ -148,6 +283,10 @@ public:
     [[eosio::action]] void decidebid(name account4sale,
                                      bool accept);
 
+    // Hold a listing for a buyer for RESERVE_SEC seconds
+    [[eosio::action]] void reserve(name account4sale,
+                                   name buyer);
+
     // Broadcast a message to a user
     [[eosio::action]] void message(name receiver,
                                    string message);
@@ -156,9 +295,42 @@ public:
     [[eosio::action]] void screener(name account4sale,
                                     uint8_t option);
 
+    // Perform screening of many accounts
+    [[eosio::action]] void screenbatch(std::vector<screenopt> screenings);
+
     // Init the stats table
     [[eosio::action]] void initstats();
 
+    // Upgrade old rows of a versioned table (returns the key to continue from)
+    [[eosio::action]] uint64_t migrate(name table,
+                                       uint64_t lower_bound,
+                                       uint32_t max_rows);
+
+    // Set the contract configuration
+    [[eosio::action]] void setconfig(uint32_t newaccount_bytes,
+                                     uint16_t newaccount_margin);
+
+    // Set the rate limit of an action
+    [[eosio::action]] void setlimit(name action,
+                                    uint8_t capacity,
+                                    uint32_t refill_sec);
+
+    // Quote the current new account fee (read-only)
+    [[eosio::action]] asset accountquote();
+
+    // Add listings missing from the category catalog and screening queue
+    [[eosio::action]] void catalogsync(name lower_bound,
+                                       uint32_t max_rows);
+
+    // Bring dutch auctions with no recent activity to their current price step (anyone can call)
+    [[eosio::action]] void dutchsync(name lower_bound,
+                                     uint32_t max_rows);
+
+    // Quote the settlement of a listed account (read-only)
+    [[eosio::action]] salequote quote(name account4sale,
+                                      name buyer,
+                                      name referrer);
+
     // ------------------
     // Contract Functions
     // ------------------
@@ -169,15 +341,45 @@ public:
              asset quantity,
              string memo);
 
+    // Check the price of a listed account and pay out the fees (the listing is left in place)
+    salequote settle_sale(const name account_to_buy, const name from, const asset quantity, const string referrer);
+
     // Buy an account listed for sale
     void buy_saleprice(const name account_to_buy, const name from, const asset quantity, const string owner_key, const string active_key, const string referrer);
 
+    // Buy an account listed for sale and list it again at a new price, without handing it to the buyer
+    void buy_relist(const name account_to_buy, const name from, const asset quantity, const asset newprice, const string referrer);
+
+    // Buy several listed accounts with one transfer
+    void buy_basket(const name from, const asset quantity, const string basket);
+
     // Buy custom accounts
     void buy_custom(const name account_name, const name from, const asset quantity, const string owner_key, const string active_key);
 
+    // Price a buyer pays for a listing: the bid price for the accepted bidder, otherwise the listing price
+    asset buyer_price(const name account4sale, const asset listprice, const name buyer);
+
+    // Fee split for a sale at the given price
+    salequote sale_settlement(const name account_to_buy, const asset saleprice, const name referrer);
+
+    // Add the seller fee payouts of a listing to payouts (split across its shop's payment accounts if set)
+    void seller_payouts(const name account4sale, const name paymentaccnt, const asset sellerfee, std::map<name, asset> &payouts);
+
+    // Escrow a wanted offer for an account that is not listed yet
+    void buy_wanted(const name account_name, const name from, const asset quantity);
+
     // Make a 12 char account
     void make_account(const name account_name, const name from, const asset quantity, const string owner_key, const string active_key);
 
+    // Add to the account creation credit
+    void buy_credit(const name from, const asset quantity);
+
+    // Send the newaccount, buyrambytes and delegatebw actions for a new account
+    void create_account(const name account_name, const authority &owner_auth, const authority &active_auth, const uint32_t ram_bytes);
+
+    // Cost of a new account at the current RAM price
+    asset newaccount_price();
+
     // Convert key from string to authority
     authority keystring_authority(string key_str);
 
@@ -200,9 +402,7 @@ private:
     const string symbol_name = "EOS";
     const symbol network_symbol = symbol(symbol_name, 4);
 
-    // Cost of new account (Feeless)
-    const asset newaccountfee = asset(4000, network_symbol); // 0.4000 EOS
-    const asset newaccountram = asset(2000, network_symbol); // 0.2000 EOS
+    // Cost of new account (Feeless). RAM is priced from the rammarket
     const asset newaccountcpu = asset(1000, network_symbol); // 0.1000 EOS
     const asset newaccountnet = asset(1000, network_symbol); // 0.1000 EOS
 #elif CHAIN == TELOS
@@ -210,9 +410,7 @@ private:
     const string symbol_name = "TLOS";
     const symbol network_symbol = symbol(symbol_name, 4);
 
-    // Cost of new account (Feeless)
-    const asset newaccountfee = asset(5000, network_symbol); // 0.5000 TLOS
-    const asset newaccountram = asset(3000, network_symbol); // 0.3000 TLOS
+    // Cost of new account (Feeless). RAM is priced from the rammarket
     const asset newaccountcpu = asset(1000, network_symbol); // 0.1000 TLOS
     const asset newaccountnet = asset(1000, network_symbol); // 0.1000 TLOS
 #elif CHAIN == WAX
@@ -220,16 +418,20 @@ private:
     const string symbol_name = "WAX";
     const symbol network_symbol = symbol(symbol_name, 8);
 
-    // Cost of new account (Feeless)
-    const asset newaccountfee = asset(50000000, network_symbol); // 0.5000 WAX
-    const asset newaccountram = asset(40000000, network_symbol); // 0.4000 WAX
+    // Cost of new account (Feeless). RAM is priced from the rammarket
     const asset newaccountcpu = asset(5000000, network_symbol);  // 0.0500 WAX
     const asset newaccountnet = asset(5000000, network_symbol);  // 0.0500 WAX
 #endif
 
-    // Contract & Referrer fee %
-    const float contract_pc = 0.02;
-    const float referrer_pc = 0.10;
+    // RAM bought for a new account unless configured
+    const uint32_t newaccountbytes = 4096;
+
+    // Current row format of the accounts, extras, bids and stats tables
+    const uint8_t ROW_VERSION = 1;
+
+    // Contract fee in basis points of the sale price, referrer fee in basis points of the contract fee
+    const int64_t contract_fee_bp = 200;
+    const int64_t referrer_fee_bp = 1000;
 
     // struct for account table
     struct [[eosio::table]] accounttable
@@ -243,6 +445,9 @@ private:
         // Account that payment will be sent to
         name paymentaccnt;
 
+        // Row format version (absent on rows written before versioning)
+        binary_extension<uint8_t> version;
+
         uint64_t primary_key() const { return account4sale.value; }
     };
 
@@ -266,6 +471,9 @@ private:
         // Message
         string message;
 
+        // Row format version (absent on rows written before versioning)
+        binary_extension<uint8_t> version;
+
         uint64_t primary_key() const { return account4sale.value; }
     };
 
@@ -286,6 +494,12 @@ private:
         // The account making the bid
         name bidder;
 
+        // Row format version (absent on rows written before versioning)
+        binary_extension<uint8_t> version;
+
+        // Number of bids proposed on the listing (absent before any bid was kept in the bid history)
+        binary_extension<uint64_t> numbids;
+
         uint64_t primary_key() const { return account4sale.value; }
     };
 
@@ -309,6 +523,9 @@ private:
         // Total sales fees
         asset tot_fees;
 
+        // Row format version (absent on rows written before versioning)
+        binary_extension<uint8_t> version;
+
         uint64_t primary_key() const { return index; }
     };
 
@@ -345,10 +562,481 @@ private:
         name payment2;
         name payment3;
 
+        // Seller fee split across the payment accounts in basis points (absent or empty = paid to the listing's payment account)
+        binary_extension<std::vector<uint16_t>> splits;
+
         uint64_t primary_key() const { return shopname.value; }
     };
 
     eosio::multi_index<name("shops"), shopstable> _shops;
+
+    // Struct for the shop items table (listings in a shop)
+    struct [[eosio::table]] shopitemtable
+    {
+        // Name of account being sold
+        name account4sale;
+
+        // Shop the account is listed in
+        name shopname;
+
+        uint64_t primary_key() const { return account4sale.value; }
+        uint64_t by_shop() const { return shopname.value; }
+    };
+
+    eosio::multi_index<name("shopitems"), shopitemtable,
+                       indexed_by<name("byshop"), const_mem_fun<shopitemtable, uint64_t, &shopitemtable::by_shop>>>
+        _shopitems;
+
+    // Struct for the catalog table (scoped by listing category)
+    struct [[eosio::table]] catalogtable
+    {
+        // Name of account being sold
+        name account4sale;
+
+        // Sale price in EOS
+        asset saleprice;
+
+        uint64_t primary_key() const { return account4sale.value; }
+        uint64_t by_price() const { return saleprice.amount; }
+    };
+
+    typedef eosio::multi_index<name("catalog"), catalogtable,
+                               indexed_by<name("byprice"), const_mem_fun<catalogtable, uint64_t, &catalogtable::by_price>>>
+        catalog_index;
+
+    // Number of sale price buckets in the category sketch
+    const uint8_t SKETCH_BUCKETS = 16;
+
+    // Sketch counts are halved once they reach this total, favouring recent sales
+    const uint32_t SKETCH_WINDOW = 256;
+
+    // Struct for the categories table (catalog scope directory)
+    struct [[eosio::table]] categorytable
+    {
+        // Catalog scope
+        name category;
+
+        // Number of accounts listed in this scope
+        uint64_t num_listed;
+
+        // Lowest sale price listed in this scope
+        asset floorprice;
+
+        // Number of accounts purchased in this scope
+        uint64_t num_purchased;
+
+        // Last sale price in this scope
+        asset lastsale;
+
+        // Recent sale prices: bucket i counts prices in [2^i, 2^(i+1)) whole tokens
+        std::vector<uint16_t> sketch;
+
+        uint64_t primary_key() const { return category.value; }
+    };
+
+    eosio::multi_index<name("categories"), categorytable> _categories;
+
+    // Number of price steps in a dutch auction
+    const uint8_t DUTCH_STEPS = 24;
+
+    // Maximum number of dutch auctions walked per dutchsync action
+    const uint32_t DUTCH_SYNC_ROWS = 50;
+
+    // Struct for the dutch auction table
+    struct [[eosio::table]] dutchtable
+    {
+        // Name of account being sold
+        name account4sale;
+
+        // Price at the start and end of the auction
+        asset startprice;
+        asset endprice;
+
+        // Auction start time
+        time_point_sec starttime;
+
+        // Auction duration in seconds
+        uint32_t duration;
+
+        // Price step last written to the accounts and catalog tables
+        uint8_t decaybucket;
+
+        uint64_t primary_key() const { return account4sale.value; }
+    };
+
+    eosio::multi_index<name("dutch"), dutchtable> _dutch;
+
+    // Struct for the wanted table
+    struct [[eosio::table]] wantedtable
+    {
+        // Offer id
+        uint64_t id;
+
+        // Name of account wanted
+        name account4sale;
+
+        // The account making the offer
+        name buyer;
+
+        // The escrowed offer price
+        asset price;
+
+        uint64_t primary_key() const { return id; }
+        uint128_t by_target() const { return (uint128_t(account4sale.value) << 64) | uint64_t(price.amount); }
+        uint64_t by_price() const { return price.amount; }
+        uint64_t by_buyer() const { return buyer.value; }
+    };
+
+    eosio::multi_index<name("wanted"), wantedtable,
+                       indexed_by<name("bytarget"), const_mem_fun<wantedtable, uint128_t, &wantedtable::by_target>>,
+                       indexed_by<name("byprice"), const_mem_fun<wantedtable, uint64_t, &wantedtable::by_price>>,
+                       indexed_by<name("bybuyer"), const_mem_fun<wantedtable, uint64_t, &wantedtable::by_buyer>>>
+        _wanted;
+
+    // Maximum number of open wanted offers per buyer (the contract pays for their ram)
+    const uint8_t WANTED_MAX_OFFERS = 10;
+
+    // Struct for the account creation credit table
+    struct [[eosio::table]] creditstable
+    {
+        // Account that deposited the credit
+        name owner;
+
+        // Unused credit
+        asset balance;
+
+        uint64_t primary_key() const { return owner.value; }
+    };
+
+    eosio::multi_index<name("credits"), creditstable> _credits;
+
+    // Struct for the referrer stats table
+    struct [[eosio::table]] refstatstable
+    {
+        // Referrer's name
+        name ref_name;
+
+        // Number of referred sales
+        uint64_t num_sales;
+
+        // Total referred sales
+        asset volume;
+
+        // Total referrer fees paid
+        asset fees;
+
+        // Time of the last referred sale
+        time_point_sec last_sale;
+
+        uint64_t primary_key() const { return ref_name.value; }
+        uint64_t by_volume() const { return volume.amount; }
+    };
+
+    eosio::multi_index<name("refstats"), refstatstable,
+                       indexed_by<name("byvolume"), const_mem_fun<refstatstable, uint64_t, &refstatstable::by_volume>>>
+        _refstats;
+
+    // Struct for the screening queue (unscreened listings)
+    struct [[eosio::table]] screeningtable
+    {
+        // Name of account being sold
+        name account4sale;
+
+        // Time the account was listed
+        time_point_sec listed;
+
+        uint64_t primary_key() const { return account4sale.value; }
+        uint64_t by_listed() const { return listed.sec_since_epoch(); }
+    };
+
+    eosio::multi_index<name("screening"), screeningtable,
+                       indexed_by<name("bylisted"), const_mem_fun<screeningtable, uint64_t, &screeningtable::by_listed>>>
+        _screening;
+
+    // Maximum number of accounts in a screenbatch request
+    const uint16_t MAX_SCREENBATCH = 100;
+
+    // Struct for the config singleton
+    struct [[eosio::table]] configtable
+    {
+        // RAM bytes bought for a new account
+        uint32_t newaccount_bytes;
+
+        // New account fee margin over cost in basis points
+        uint16_t newaccount_margin;
+
+        // Per action rate limits (absent on configs set before rate limiting)
+        binary_extension<std::vector<ratelimit>> ratelimits;
+    };
+
+    eosio::singleton<name("config"), configtable> _config;
+
+    // Struct for the rate limit table (scoped by action)
+    struct [[eosio::table]] throttletable
+    {
+        // Account calling the action
+        name account;
+
+        // Time the bucket was last refilled
+        time_point_sec refilled;
+
+        // Calls left in the bucket
+        uint8_t tokens;
+
+        // Time the bucket is full again. Full buckets are erased, as a new bucket starts full
+        time_point_sec full;
+
+        uint64_t primary_key() const { return account.value; }
+        uint64_t by_full() const { return full.sec_since_epoch(); }
+    };
+
+    typedef eosio::multi_index<name("throttle"), throttletable,
+                               indexed_by<name("byfull"), const_mem_fun<throttletable, uint64_t, &throttletable::by_full>>>
+        throttle_index;
+
+    // Maximum number of full buckets erased per rate limited call
+    const uint8_t THROTTLE_COLLECT = 3;
+
+    // Struct for the change sequence table (last change of each listing)
+    struct [[eosio::table]] changestable
+    {
+        // Name of account being sold
+        name account4sale;
+
+        // Sequence number of the last change to the listing rows
+        uint64_t seq;
+
+        uint64_t primary_key() const { return account4sale.value; }
+        uint64_t by_seq() const { return seq; }
+    };
+
+    eosio::multi_index<name("changes"), changestable,
+                       indexed_by<name("byseq"), const_mem_fun<changestable, uint64_t, &changestable::by_seq>>>
+        _changes;
+
+    // Maximum number of rows kept in the tombstones table
+    const uint32_t MAX_TOMBSTONES = 1000;
+
+    // Struct for the tombstones table (listings erased since the oldest kept sequence)
+    struct [[eosio::table]] tombstonetable
+    {
+        // Sequence number of the erase
+        uint64_t seq;
+
+        // Name of account that was listed
+        name account4sale;
+
+        uint64_t primary_key() const { return seq; }
+    };
+
+    eosio::multi_index<name("tombstones"), tombstonetable> _tombstones;
+
+    // Struct for the change sequence singleton
+    struct [[eosio::table]] syncstate
+    {
+        // Next change sequence number
+        uint64_t next_seq;
+
+        // Highest sequence dropped from the tombstones table. Mirrors older than this must reload
+        uint64_t tomb_floor;
+
+        // Number of rows in the tombstones table
+        uint32_t num_tombstones;
+    };
+
+    eosio::singleton<name("sync"), syncstate> _sync;
+
+    // Trending score epoch (2024-01-01) and half-life in seconds
+    const uint32_t TREND_EPOCH = 1704067200;
+    const uint32_t TREND_HALFLIFE = 86400;
+
+    // Trending weight of a vote and a bid
+    const double TREND_VOTE = 1.0;
+    const double TREND_BID = 3.0;
+
+    // Struct for the trending table
+    struct [[eosio::table]] trendingtable
+    {
+        // Name of account being sold
+        name account4sale;
+
+        // log2 of the decayed activity, measured at TREND_EPOCH. Subtract (now - TREND_EPOCH) / TREND_HALFLIFE for the current value
+        double score;
+
+        uint64_t primary_key() const { return account4sale.value; }
+        double by_score() const { return score; }
+    };
+
+    eosio::multi_index<name("trending"), trendingtable,
+                       indexed_by<name("byscore"), const_mem_fun<trendingtable, double, &trendingtable::by_score>>>
+        _trending;
+
+    // Seconds a reservation holds a listing
+    const uint32_t RESERVE_SEC = 10;
+
+    // Reservation periods a listing cannot be reserved again after a reservation expires,
+    // so no buyer or group of buyers can hold a listing indefinitely
+    const uint32_t RESERVE_COOLDOWN = 3;
+
+    // Maximum number of expired reservations erased per reserve action
+    const uint8_t RESERVE_COLLECT = 3;
+
+    // Struct for the reservations table
+    struct [[eosio::table]] reservetable
+    {
+        // Name of account being sold
+        name account4sale;
+
+        // Only buyer until the reservation expires
+        name buyer;
+
+        // Time the reservation expires. The row is kept until its cooldown ends
+        time_point_sec expires;
+
+        uint64_t primary_key() const { return account4sale.value; }
+        uint64_t by_expires() const { return expires.sec_since_epoch(); }
+    };
+
+    eosio::multi_index<name("reserves"), reservetable,
+                       indexed_by<name("byexpires"), const_mem_fun<reservetable, uint64_t, &reservetable::by_expires>>>
+        _reserves;
+
+    // Number of sales in the recent sales feed and bids in each listing's bid history
+    const uint64_t SALE_FEED_SIZE = 50;
+    const uint64_t BID_HISTORY_SIZE = 10;
+
+    // Struct for the recent sales feed (ring buffer: sale n is kept in slot n % SALE_FEED_SIZE)
+    struct [[eosio::table]] salefeedtable
+    {
+        // Ring buffer slot
+        uint64_t slot;
+
+        // Sale number (newest sale has the highest)
+        uint64_t seq;
+
+        // Name of account sold
+        name account4sale;
+
+        // The account that bought it
+        name buyer;
+
+        // Sale price in EOS
+        asset saleprice;
+
+        // Time of the sale
+        time_point_sec sold;
+
+        uint64_t primary_key() const { return slot; }
+    };
+
+    eosio::multi_index<name("salefeed"), salefeedtable> _salefeed;
+
+    // Struct for the feed state singleton
+    struct [[eosio::table]] feedstate
+    {
+        // Number of sales recorded in the recent sales feed
+        uint64_t num_sales;
+    };
+
+    eosio::singleton<name("feedstate"), feedstate> _feedstate;
+
+    // Struct for the bid history (scoped by account4sale, ring buffer: bid n is kept in slot n % BID_HISTORY_SIZE)
+    struct [[eosio::table]] bidhisttable
+    {
+        // Ring buffer slot
+        uint64_t slot;
+
+        // Bid number on the listing (newest bid has the highest)
+        uint64_t seq;
+
+        // The account making the bid
+        name bidder;
+
+        // The bid price
+        asset bidprice;
+
+        // Time of the bid
+        time_point_sec proposed;
+
+        uint64_t primary_key() const { return slot; }
+    };
+
+    typedef eosio::multi_index<name("bidhistory"), bidhisttable> bidhist_index;
+
+    // ----------------
+    // Table helpers
+    // ----------------
+
+    // Bring a row to the current format. Fields added in later versions get their defaults here
+    template <typename T>
+    void upgrade_row(T &row)
+    {
+        if (!row.version.has_value() || row.version.value() < ROW_VERSION)
+        {
+            row.version = ROW_VERSION;
+        }
+    }
+
+    // Upgrade at most max_rows rows from lower_bound (returns the key to continue from)
+    template <typename Table>
+    uint64_t migrate_table(Table &table, const uint64_t lower_bound, const uint32_t max_rows);
+
+    // Take a call from the account's token bucket for the action (fails when empty)
+    void throttle(const name action, const name account);
+
+    // Stamp the next change sequence on a listing (payer is only billed for a new row)
+    void stamp_change(const name account4sale, const name payer);
+
+    // Replace the change sequence of an erased listing with a tombstone
+    void tombstone_change(const name account4sale);
+
+    // Add activity to a listing's trending score
+    void trend_add(const name account4sale, const double weight);
+
+    // Fail if another buyer holds an unexpired reservation on the listing
+    void check_reserve(const name account4sale, const name buyer);
+
+    // Erase up to RESERVE_COLLECT reservations whose cooldown has ended
+    void collect_reserves();
+
+    // Erase up to THROTTLE_COLLECT buckets that have refilled completely
+    void collect_throttles(throttle_index &throttles);
+
+    // Write a sale over the oldest slot of the recent sales feed
+    void record_sale(const name account4sale, const name buyer, const asset saleprice);
+
+    // Write bid number seq over the oldest slot of the listing's bid history (payer is billed for the slot)
+    void record_bid(const name account4sale, const uint64_t seq, const name bidder, const asset bidprice);
+
+    // Erase a listing from all listing tables
+    void erase_listing(const name account4sale);
+
+    // Set the screening status of a listing and update the screening queue
+    void screen_listing(const name account4sale, const uint8_t option);
+
+    // Current price of a listing (evaluates dutch auctions)
+    asset listing_price(const name account4sale, const asset saleprice);
+
+    // Current price step of a dutch auction
+    uint8_t dutch_bucket(const dutchtable &auction);
+
+    // Write the current dutch auction price to the accounts and catalog tables
+    void dutch_refresh(const name account4sale);
+
+    // Catalog scope of an account: its suffix (e.g. x) or its length (e.g. len.four)
+    name listing_category(const name account);
+
+    // Add/update/erase a listing in the category catalog
+    void catalog_add(const name account4sale, const asset saleprice, const name payer);
+    void catalog_update(const name account4sale, const asset saleprice);
+    void catalog_erase(const name account4sale);
+
+    // Record a sale in the category summary
+    void catalog_sale(const name account4sale, const asset saleprice);
+
+    // Update the category summary after its catalog changed
+    void category_refresh(const name category, const catalog_index &catalog, const int64_t delta_listed);
 };
 
 } // namespace eosio
+
@@ -0,0 +1,992 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ *
+ *  Offline cost profiler. Runs a scripted sequence of actions against a native
+ *  build of the contract, with every chain intrinsic it calls replaced by an
+ *  in-memory shim that counts calls, bytes, inline actions and row bytes.
+ *
+ *  The contract is built with EOSNAMESWAPS_TRACE, so the report also counts
+ *  dispatches, failed checks and inline actions per entry point, and failed
+ *  checks by call site.
+ *
+ *  Usage: eosnameswaps_profiler [--json <file>] [--report <file>] [--golden <file> [--update]]
+ *
+ *  Draft: this file has not been compiled against eosio.cdt yet and there is
+ *  no profiler/golden.txt (see README.txt).
+ */
+
+#include <eosio/tester.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+// The contract header and the eosio headers it includes come first, so the check() hook below only
+// rewrites the calls in the contract's own source
+#include "eosnameswaps.hpp"
+
+// Instrumented build: hooks counting dispatches and failed checks by call site (defined below)
+namespace eosnameswaps_trace
+{
+void dispatch(uint64_t receiver, uint64_t code, uint64_t action);
+void failed_check(const char *file, int line, std::string_view msg);
+} // namespace eosnameswaps_trace
+
+#define EOSNAMESWAPS_TRACE
+#define check(pred, msg) ((pred) ? (void)0 : (eosnameswaps_trace::failed_check(__FILE__, __LINE__, (msg)), eosio::check(false, (msg))))
+#include "eosnameswaps.cpp"
+#undef check
+
+using namespace eosio::native;
+
+namespace profiler
+{
+
+using eosio::asset;
+using eosio::name;
+using eosio::symbol;
+
+// Raised by the eosio_assert and eosio_exit shims so an action unwinds to the runner
+struct assert_failure : std::runtime_error
+{
+    using std::runtime_error::runtime_error;
+};
+
+struct action_exit
+{
+};
+
+// Cost of one action
+struct cost_profile
+{
+    // Intrinsic name -> number of calls
+    std::map<std::string, uint64_t> calls;
+
+    // Intrinsic name -> bytes passed in or out
+    std::map<std::string, uint64_t> bytes;
+
+    // Inline actions sent (contract::action)
+    std::vector<std::string> inline_actions;
+
+    // Row bytes stored minus row bytes removed
+    int64_t ram_delta = 0;
+
+    // check() message if the action failed
+    std::string error;
+};
+
+cost_profile *current = nullptr;
+
+void record(const char *intrinsic, uint64_t nbytes = 0)
+{
+    if (current == nullptr)
+        return;
+
+    current->calls[intrinsic]++;
+    current->bytes[intrinsic] += nbytes;
+}
+
+void ram(int64_t delta)
+{
+    if (current != nullptr)
+        current->ram_delta += delta;
+}
+
+// ---------------------------------------------------------------
+// Trace counters (EOSNAMESWAPS_TRACE hooks)
+// ---------------------------------------------------------------
+
+// Counters of one entry point
+struct entry_trace
+{
+    uint64_t dispatches = 0;
+    uint64_t failed = 0;
+    uint64_t inline_actions = 0;
+};
+
+// Entry point (code::action) -> counters
+std::map<std::string, entry_trace> entry_traces;
+
+// Call site (file:line message) -> failed checks
+std::map<std::string, uint64_t> failed_sites;
+
+// Entry point of the running action
+std::string dispatched;
+
+} // namespace profiler
+
+void eosnameswaps_trace::dispatch(uint64_t receiver, uint64_t code, uint64_t action)
+{
+    profiler::dispatched = eosio::name(code).to_string() + "::" + eosio::name(action).to_string();
+    profiler::entry_traces[profiler::dispatched].dispatches++;
+}
+
+void eosnameswaps_trace::failed_check(const char *file, int line, std::string_view msg)
+{
+    const char *base = strrchr(file, '/');
+    profiler::failed_sites[std::string(base ? base + 1 : file) + ":" + std::to_string(line) + " " + std::string(msg)]++;
+}
+
+namespace profiler
+{
+
+// ---------------------------------------------------------------
+// In-memory database with chain iterator semantics
+// ---------------------------------------------------------------
+
+// (code, scope, table)
+typedef std::tuple<uint64_t, uint64_t, uint64_t> table_id;
+
+// Iterators >= 0 point at rows, -1 means no table, other negative values are end iterators
+template <typename Position>
+struct iterator_cache
+{
+    std::vector<std::pair<table_id, Position>> rows;
+    std::vector<table_id> ends;
+
+    int32_t add(const table_id &tid, const Position &pos)
+    {
+        rows.emplace_back(tid, pos);
+        return int32_t(rows.size() - 1);
+    }
+
+    int32_t end(const table_id &tid)
+    {
+        auto itr = std::find(ends.begin(), ends.end(), tid);
+        if (itr == ends.end())
+            itr = ends.insert(ends.end(), tid);
+        return -2 - int32_t(itr - ends.begin());
+    }
+
+    const table_id &table(int32_t it) const
+    {
+        return it >= 0 ? rows.at(it).first : ends.at(-2 - it);
+    }
+};
+
+struct primary_db
+{
+    struct row
+    {
+        std::vector<char> data;
+        uint64_t payer;
+    };
+
+    std::map<table_id, std::map<uint64_t, row>> tables;
+    iterator_cache<uint64_t> iterators;
+
+    int32_t store(const table_id &tid, uint64_t id, uint64_t payer, const void *data, uint32_t len)
+    {
+        auto &rows = tables[tid];
+        if (rows.count(id) != 0)
+            throw assert_failure("db_store_i64: primary key already exists");
+
+        rows[id] = row{std::vector<char>((const char *)data, (const char *)data + len), payer};
+        ram(len);
+        return iterators.add(tid, id);
+    }
+
+    row &get(int32_t it)
+    {
+        if (it < 0)
+            throw assert_failure("db: dereference of end iterator");
+
+        auto &pos = iterators.rows.at(it);
+        auto r = tables[pos.first].find(pos.second);
+        if (r == tables[pos.first].end())
+            throw assert_failure("db: dereference of erased row");
+        return r->second;
+    }
+
+    void update(int32_t it, uint64_t payer, const void *data, uint32_t len)
+    {
+        row &r = get(it);
+        ram(int64_t(len) - int64_t(r.data.size()));
+        r.data.assign((const char *)data, (const char *)data + len);
+        if (payer != 0)
+            r.payer = payer;
+    }
+
+    void remove(int32_t it)
+    {
+        row &r = get(it);
+        ram(-int64_t(r.data.size()));
+        auto &pos = iterators.rows.at(it);
+        tables[pos.first].erase(pos.second);
+    }
+
+    int32_t find(const table_id &tid, uint64_t id)
+    {
+        auto t = tables.find(tid);
+        if (t == tables.end())
+            return -1;
+        if (t->second.count(id) == 0)
+            return iterators.end(tid);
+        return iterators.add(tid, id);
+    }
+
+    template <typename Bound>
+    int32_t bound(const table_id &tid, Bound bound_fn)
+    {
+        auto t = tables.find(tid);
+        if (t == tables.end())
+            return -1;
+        auto r = bound_fn(t->second);
+        if (r == t->second.end())
+            return iterators.end(tid);
+        return iterators.add(tid, r->first);
+    }
+
+    int32_t end(const table_id &tid)
+    {
+        if (tables.find(tid) == tables.end())
+            return -1;
+        return iterators.end(tid);
+    }
+
+    int32_t next(int32_t it, uint64_t *primary)
+    {
+        if (it < 0)
+            return -1;
+
+        const auto &pos = iterators.rows.at(it);
+        auto &rows = tables[pos.first];
+        auto r = rows.upper_bound(pos.second);
+        if (r == rows.end())
+            return iterators.end(pos.first);
+
+        *primary = r->first;
+        return iterators.add(pos.first, r->first);
+    }
+
+    int32_t previous(int32_t it, uint64_t *primary)
+    {
+        if (it == -1)
+            return -1;
+
+        const table_id tid = iterators.table(it);
+        auto &rows = tables[tid];
+        auto r = it < 0 ? rows.end() : rows.lower_bound(iterators.rows.at(it).second);
+        if (r == rows.begin())
+            return -1;
+
+        --r;
+        *primary = r->first;
+        return iterators.add(tid, r->first);
+    }
+};
+
+template <typename Key>
+struct secondary_db
+{
+    struct entry
+    {
+        Key secondary;
+        uint64_t primary;
+
+        bool operator<(const entry &other) const
+        {
+            return std::tie(secondary, primary) < std::tie(other.secondary, other.primary);
+        }
+    };
+
+    std::map<table_id, std::set<entry>> tables;
+    iterator_cache<entry> iterators;
+
+    int32_t store(const table_id &tid, uint64_t id, const Key &secondary)
+    {
+        tables[tid].insert(entry{secondary, id});
+        ram(sizeof(Key) + sizeof(uint64_t));
+        return iterators.add(tid, entry{secondary, id});
+    }
+
+    void update(int32_t it, const Key &secondary)
+    {
+        auto &pos = iterators.rows.at(it);
+        auto &rows = tables[pos.first];
+        rows.erase(pos.second);
+        pos.second.secondary = secondary;
+        rows.insert(pos.second);
+    }
+
+    void remove(int32_t it)
+    {
+        auto &pos = iterators.rows.at(it);
+        tables[pos.first].erase(pos.second);
+        ram(-int64_t(sizeof(Key) + sizeof(uint64_t)));
+    }
+
+    int32_t found(const table_id &tid, typename std::set<entry>::iterator r, Key *secondary, uint64_t *primary)
+    {
+        if (r == tables[tid].end())
+            return iterators.end(tid);
+        if (secondary != nullptr)
+            *secondary = r->secondary;
+        if (primary != nullptr)
+            *primary = r->primary;
+        return iterators.add(tid, *r);
+    }
+
+    int32_t find_primary(const table_id &tid, Key *secondary, uint64_t primary)
+    {
+        auto t = tables.find(tid);
+        if (t == tables.end())
+            return -1;
+        auto r = std::find_if(t->second.begin(), t->second.end(), [&](const entry &e) { return e.primary == primary; });
+        return found(tid, r, secondary, nullptr);
+    }
+
+    int32_t find_secondary(const table_id &tid, const Key *secondary, uint64_t *primary)
+    {
+        auto t = tables.find(tid);
+        if (t == tables.end())
+            return -1;
+        auto r = t->second.lower_bound(entry{*secondary, 0});
+        if (r != t->second.end() && !(r->secondary == *secondary))
+            r = t->second.end();
+        return found(tid, r, nullptr, primary);
+    }
+
+    int32_t lowerbound(const table_id &tid, Key *secondary, uint64_t *primary)
+    {
+        auto t = tables.find(tid);
+        if (t == tables.end())
+            return -1;
+        return found(tid, t->second.lower_bound(entry{*secondary, 0}), secondary, primary);
+    }
+
+    int32_t upperbound(const table_id &tid, Key *secondary, uint64_t *primary)
+    {
+        auto t = tables.find(tid);
+        if (t == tables.end())
+            return -1;
+        return found(tid, t->second.upper_bound(entry{*secondary, UINT64_MAX}), secondary, primary);
+    }
+
+    int32_t end(const table_id &tid)
+    {
+        if (tables.find(tid) == tables.end())
+            return -1;
+        return iterators.end(tid);
+    }
+
+    int32_t next(int32_t it, uint64_t *primary)
+    {
+        if (it < 0)
+            return -1;
+        const auto pos = iterators.rows.at(it);
+        return found(pos.first, tables[pos.first].upper_bound(pos.second), nullptr, primary);
+    }
+
+    int32_t previous(int32_t it, uint64_t *primary)
+    {
+        if (it == -1)
+            return -1;
+
+        const table_id tid = iterators.table(it);
+        auto &rows = tables[tid];
+        auto r = it < 0 ? rows.end() : rows.lower_bound(iterators.rows.at(it).second);
+        if (r == rows.begin())
+            return -1;
+        return found(tid, --r, nullptr, primary);
+    }
+};
+
+struct chain_state
+{
+    primary_db primary;
+    secondary_db<uint64_t> idx64;
+    secondary_db<uint128_t> idx128;
+    secondary_db<double> idx_double;
+};
+
+chain_state state;
+
+// Action being executed
+name receiver;
+std::vector<char> action_data;
+std::vector<name> authorizers;
+uint64_t now_us = 1577836800ull * 1000000; // 2020-01-01
+
+bool authorized(uint64_t account)
+{
+    return std::find(authorizers.begin(), authorizers.end(), name(account)) != authorizers.end();
+}
+
+// ---------------------------------------------------------------
+// Intrinsic shims
+// ---------------------------------------------------------------
+
+void install()
+{
+    // Action context
+    intrinsics::set_intrinsic<intrinsics::current_receiver>([]() -> uint64_t {
+        record("current_receiver");
+        return receiver.value;
+    });
+    intrinsics::set_intrinsic<intrinsics::action_data_size>([]() -> uint32_t {
+        record("action_data_size");
+        return action_data.size();
+    });
+    intrinsics::set_intrinsic<intrinsics::read_action_data>([](void *msg, uint32_t len) -> uint32_t {
+        const uint32_t copied = std::min<uint32_t>(len, action_data.size());
+        record("read_action_data", copied);
+        memcpy(msg, action_data.data(), copied);
+        return copied;
+    });
+    intrinsics::set_intrinsic<intrinsics::current_time>([]() -> uint64_t {
+        record("current_time");
+        return now_us;
+    });
+
+    // Authorization
+    intrinsics::set_intrinsic<intrinsics::require_auth>([](uint64_t account) {
+        record("require_auth");
+        if (!authorized(account))
+            throw assert_failure("missing authority of " + name(account).to_string());
+    });
+    intrinsics::set_intrinsic<intrinsics::require_auth2>([](uint64_t account, uint64_t permission) {
+        record("require_auth2");
+        if (!authorized(account))
+            throw assert_failure("missing authority of " + name(account).to_string() + "@" + name(permission).to_string());
+    });
+    intrinsics::set_intrinsic<intrinsics::has_auth>([](uint64_t account) -> bool {
+        record("has_auth");
+        return authorized(account);
+    });
+    intrinsics::set_intrinsic<intrinsics::is_account>([](uint64_t) -> bool {
+        record("is_account");
+        return true;
+    });
+    intrinsics::set_intrinsic<intrinsics::require_recipient>([](uint64_t) {
+        record("require_recipient");
+    });
+
+    // Inline actions and return values
+    intrinsics::set_intrinsic<intrinsics::send_inline>([](char *serialized_action, size_t size) {
+        record("send_inline", size);
+
+        uint64_t contract, action_name;
+        memcpy(&contract, serialized_action, sizeof(uint64_t));
+        memcpy(&action_name, serialized_action + sizeof(uint64_t), sizeof(uint64_t));
+        if (current != nullptr)
+            current->inline_actions.push_back(name(contract).to_string() + "::" + name(action_name).to_string());
+    });
+    intrinsics::set_intrinsic<intrinsics::set_action_return_value>([](void *, size_t size) {
+        record("set_action_return_value", size);
+    });
+
+    // Failures
+    intrinsics::set_intrinsic<intrinsics::eosio_assert>([](uint32_t test, const char *msg) {
+        record("eosio_assert");
+        if (!test)
+            throw assert_failure(msg);
+    });
+    intrinsics::set_intrinsic<intrinsics::eosio_assert_message>([](uint32_t test, const char *msg, uint32_t msg_len) {
+        record("eosio_assert_message");
+        if (!test)
+            throw assert_failure(std::string(msg, msg_len));
+    });
+    intrinsics::set_intrinsic<intrinsics::eosio_exit>([](int32_t) {
+        throw action_exit();
+    });
+
+    // Primary index
+    intrinsics::set_intrinsic<intrinsics::db_store_i64>([](uint64_t scope, uint64_t table, uint64_t payer, uint64_t id, const void *data, uint32_t len) -> int32_t {
+        record("db_store_i64", len);
+        return state.primary.store(table_id{receiver.value, scope, table}, id, payer, data, len);
+    });
+    intrinsics::set_intrinsic<intrinsics::db_update_i64>([](int32_t it, uint64_t payer, const void *data, uint32_t len) {
+        record("db_update_i64", len);
+        state.primary.update(it, payer, data, len);
+    });
+    intrinsics::set_intrinsic<intrinsics::db_remove_i64>([](int32_t it) {
+        record("db_remove_i64");
+        state.primary.remove(it);
+    });
+    intrinsics::set_intrinsic<intrinsics::db_get_i64>([](int32_t it, const void *data, uint32_t len) -> int32_t {
+        const auto &row = state.primary.get(it);
+        const uint32_t copied = std::min<uint32_t>(len, row.data.size());
+        record("db_get_i64", copied);
+        memcpy(const_cast<void *>(data), row.data.data(), copied);
+        return row.data.size();
+    });
+    intrinsics::set_intrinsic<intrinsics::db_next_i64>([](int32_t it, uint64_t *primary) -> int32_t {
+        record("db_next_i64");
+        return state.primary.next(it, primary);
+    });
+    intrinsics::set_intrinsic<intrinsics::db_previous_i64>([](int32_t it, uint64_t *primary) -> int32_t {
+        record("db_previous_i64");
+        return state.primary.previous(it, primary);
+    });
+    intrinsics::set_intrinsic<intrinsics::db_find_i64>([](uint64_t code, uint64_t scope, uint64_t table, uint64_t id) -> int32_t {
+        record("db_find_i64");
+        return state.primary.find(table_id{code, scope, table}, id);
+    });
+    intrinsics::set_intrinsic<intrinsics::db_lowerbound_i64>([](uint64_t code, uint64_t scope, uint64_t table, uint64_t id) -> int32_t {
+        record("db_lowerbound_i64");
+        return state.primary.bound(table_id{code, scope, table}, [&](auto &rows) { return rows.lower_bound(id); });
+    });
+    intrinsics::set_intrinsic<intrinsics::db_upperbound_i64>([](uint64_t code, uint64_t scope, uint64_t table, uint64_t id) -> int32_t {
+        record("db_upperbound_i64");
+        return state.primary.bound(table_id{code, scope, table}, [&](auto &rows) { return rows.upper_bound(id); });
+    });
+    intrinsics::set_intrinsic<intrinsics::db_end_i64>([](uint64_t code, uint64_t scope, uint64_t table) -> int32_t {
+        record("db_end_i64");
+        return state.primary.end(table_id{code, scope, table});
+    });
+
+    // Secondary indices
+    intrinsics::set_intrinsic<intrinsics::db_idx64_store>([](uint64_t scope, uint64_t table, uint64_t, uint64_t id, const uint64_t *secondary) -> int32_t {
+        record("db_idx64_store", sizeof(uint64_t));
+        return state.idx64.store(table_id{receiver.value, scope, table}, id, *secondary);
+    });
+    intrinsics::set_intrinsic<intrinsics::db_idx64_update>([](int32_t it, uint64_t, const uint64_t *secondary) {
+        record("db_idx64_update", sizeof(uint64_t));
+        state.idx64.update(it, *secondary);
+    });
+    intrinsics::set_intrinsic<intrinsics::db_idx64_remove>([](int32_t it) {
+        record("db_idx64_remove");
+        state.idx64.remove(it);
+    });
+    intrinsics::set_intrinsic<intrinsics::db_idx64_next>([](int32_t it, uint64_t *primary) -> int32_t {
+        record("db_idx64_next");
+        return state.idx64.next(it, primary);
+    });
+    intrinsics::set_intrinsic<intrinsics::db_idx64_previous>([](int32_t it, uint64_t *primary) -> int32_t {
+        record("db_idx64_previous");
+        return state.idx64.previous(it, primary);
+    });
+    intrinsics::set_intrinsic<intrinsics::db_idx64_find_primary>([](uint64_t code, uint64_t scope, uint64_t table, uint64_t *secondary, uint64_t primary) -> int32_t {
+        record("db_idx64_find_primary");
+        return state.idx64.find_primary(table_id{code, scope, table}, secondary, primary);
+    });
+    intrinsics::set_intrinsic<intrinsics::db_idx64_find_secondary>([](uint64_t code, uint64_t scope, uint64_t table, const uint64_t *secondary, uint64_t *primary) -> int32_t {
+        record("db_idx64_find_secondary");
+        return state.idx64.find_secondary(table_id{code, scope, table}, secondary, primary);
+    });
+    intrinsics::set_intrinsic<intrinsics::db_idx64_lowerbound>([](uint64_t code, uint64_t scope, uint64_t table, uint64_t *secondary, uint64_t *primary) -> int32_t {
+        record("db_idx64_lowerbound");
+        return state.idx64.lowerbound(table_id{code, scope, table}, secondary, primary);
+    });
+    intrinsics::set_intrinsic<intrinsics::db_idx64_upperbound>([](uint64_t code, uint64_t scope, uint64_t table, uint64_t *secondary, uint64_t *primary) -> int32_t {
+        record("db_idx64_upperbound");
+        return state.idx64.upperbound(table_id{code, scope, table}, secondary, primary);
+    });
+    intrinsics::set_intrinsic<intrinsics::db_idx64_end>([](uint64_t code, uint64_t scope, uint64_t table) -> int32_t {
+        record("db_idx64_end");
+        return state.idx64.end(table_id{code, scope, table});
+    });
+
+    intrinsics::set_intrinsic<intrinsics::db_idx128_store>([](uint64_t scope, uint64_t table, uint64_t, uint64_t id, const uint128_t *secondary) -> int32_t {
+        record("db_idx128_store", sizeof(uint128_t));
+        return state.idx128.store(table_id{receiver.value, scope, table}, id, *secondary);
+    });
+    intrinsics::set_intrinsic<intrinsics::db_idx128_update>([](int32_t it, uint64_t, const uint128_t *secondary) {
+        record("db_idx128_update", sizeof(uint128_t));
+        state.idx128.update(it, *secondary);
+    });
+    intrinsics::set_intrinsic<intrinsics::db_idx128_remove>([](int32_t it) {
+        record("db_idx128_remove");
+        state.idx128.remove(it);
+    });
+    intrinsics::set_intrinsic<intrinsics::db_idx128_next>([](int32_t it, uint64_t *primary) -> int32_t {
+        record("db_idx128_next");
+        return state.idx128.next(it, primary);
+    });
+    intrinsics::set_intrinsic<intrinsics::db_idx128_previous>([](int32_t it, uint64_t *primary) -> int32_t {
+        record("db_idx128_previous");
+        return state.idx128.previous(it, primary);
+    });
+    intrinsics::set_intrinsic<intrinsics::db_idx128_find_primary>([](uint64_t code, uint64_t scope, uint64_t table, uint128_t *secondary, uint64_t primary) -> int32_t {
+        record("db_idx128_find_primary");
+        return state.idx128.find_primary(table_id{code, scope, table}, secondary, primary);
+    });
+    intrinsics::set_intrinsic<intrinsics::db_idx128_find_secondary>([](uint64_t code, uint64_t scope, uint64_t table, const uint128_t *secondary, uint64_t *primary) -> int32_t {
+        record("db_idx128_find_secondary");
+        return state.idx128.find_secondary(table_id{code, scope, table}, secondary, primary);
+    });
+    intrinsics::set_intrinsic<intrinsics::db_idx128_lowerbound>([](uint64_t code, uint64_t scope, uint64_t table, uint128_t *secondary, uint64_t *primary) -> int32_t {
+        record("db_idx128_lowerbound");
+        return state.idx128.lowerbound(table_id{code, scope, table}, secondary, primary);
+    });
+    intrinsics::set_intrinsic<intrinsics::db_idx128_upperbound>([](uint64_t code, uint64_t scope, uint64_t table, uint128_t *secondary, uint64_t *primary) -> int32_t {
+        record("db_idx128_upperbound");
+        return state.idx128.upperbound(table_id{code, scope, table}, secondary, primary);
+    });
+    intrinsics::set_intrinsic<intrinsics::db_idx128_end>([](uint64_t code, uint64_t scope, uint64_t table) -> int32_t {
+        record("db_idx128_end");
+        return state.idx128.end(table_id{code, scope, table});
+    });
+
+    // Double secondary index (trending scores)
+    intrinsics::set_intrinsic<intrinsics::db_idx_double_store>([](uint64_t scope, uint64_t table, uint64_t, uint64_t id, const double *secondary) -> int32_t {
+        record("db_idx_double_store", sizeof(double));
+        return state.idx_double.store(table_id{receiver.value, scope, table}, id, *secondary);
+    });
+    intrinsics::set_intrinsic<intrinsics::db_idx_double_update>([](int32_t it, uint64_t, const double *secondary) {
+        record("db_idx_double_update", sizeof(double));
+        state.idx_double.update(it, *secondary);
+    });
+    intrinsics::set_intrinsic<intrinsics::db_idx_double_remove>([](int32_t it) {
+        record("db_idx_double_remove");
+        state.idx_double.remove(it);
+    });
+    intrinsics::set_intrinsic<intrinsics::db_idx_double_next>([](int32_t it, uint64_t *primary) -> int32_t {
+        record("db_idx_double_next");
+        return state.idx_double.next(it, primary);
+    });
+    intrinsics::set_intrinsic<intrinsics::db_idx_double_previous>([](int32_t it, uint64_t *primary) -> int32_t {
+        record("db_idx_double_previous");
+        return state.idx_double.previous(it, primary);
+    });
+    intrinsics::set_intrinsic<intrinsics::db_idx_double_find_primary>([](uint64_t code, uint64_t scope, uint64_t table, double *secondary, uint64_t primary) -> int32_t {
+        record("db_idx_double_find_primary");
+        return state.idx_double.find_primary(table_id{code, scope, table}, secondary, primary);
+    });
+    intrinsics::set_intrinsic<intrinsics::db_idx_double_find_secondary>([](uint64_t code, uint64_t scope, uint64_t table, const double *secondary, uint64_t *primary) -> int32_t {
+        record("db_idx_double_find_secondary");
+        return state.idx_double.find_secondary(table_id{code, scope, table}, secondary, primary);
+    });
+    intrinsics::set_intrinsic<intrinsics::db_idx_double_lowerbound>([](uint64_t code, uint64_t scope, uint64_t table, double *secondary, uint64_t *primary) -> int32_t {
+        record("db_idx_double_lowerbound");
+        return state.idx_double.lowerbound(table_id{code, scope, table}, secondary, primary);
+    });
+    intrinsics::set_intrinsic<intrinsics::db_idx_double_upperbound>([](uint64_t code, uint64_t scope, uint64_t table, double *secondary, uint64_t *primary) -> int32_t {
+        record("db_idx_double_upperbound");
+        return state.idx_double.upperbound(table_id{code, scope, table}, secondary, primary);
+    });
+    intrinsics::set_intrinsic<intrinsics::db_idx_double_end>([](uint64_t code, uint64_t scope, uint64_t table) -> int32_t {
+        record("db_idx_double_end");
+        return state.idx_double.end(table_id{code, scope, table});
+    });
+}
+
+// ---------------------------------------------------------------
+// Scripted actions
+// ---------------------------------------------------------------
+
+const name contract = name("eosnameswaps");
+const symbol wax_symbol = symbol("WAX", 8);
+const std::string key = "EOS6MRyAjQq8ud7hVNYcfnVPJqcVpscN5So8BhtHuGYqET5GDW5CV";
+
+asset wax(int64_t whole)
+{
+    return asset(whole * 100000000, wax_symbol);
+}
+
+struct scripted_action
+{
+    std::string label;
+    name code;
+    name action_name;
+    std::vector<char> data;
+    std::vector<name> auths;
+};
+
+template <typename... Args>
+scripted_action contract_action(const std::string &label, const char *action_name, std::vector<name> auths, Args... args)
+{
+    return scripted_action{label, contract, name(action_name), eosio::pack(std::make_tuple(args...)), auths};
+}
+
+scripted_action transfer(const std::string &label, name from, asset quantity, const std::string &memo)
+{
+    return scripted_action{label, name("eosio.token"), name("transfer"), eosio::pack(std::make_tuple(from, contract, quantity, memo)), {from}};
+}
+
+// Listing, bidding, settlement and account creation paths
+std::vector<scripted_action> script()
+{
+    const std::string keys = key + "," + key;
+
+    return {
+        contract_action("initstats", "initstats", {contract}),
+        contract_action("regref", "regref", {contract}, name("ref"), name("refpayout")),
+        contract_action("sell", "sell", {name("forsale1")}, name("forsale1"), wax(10), name("seller"), std::string("Nice name")),
+        contract_action("update", "update", {name("seller")}, name("forsale1"), wax(12), std::string("Nicer name")),
+        contract_action("vote", "vote", {name("voter")}, name("forsale1"), name("voter")),
+        contract_action("proposebid", "proposebid", {name("bidder")}, name("forsale1"), wax(5), name("bidder")),
+        contract_action("decidebid", "decidebid", {name("seller")}, name("forsale1"), true),
+        contract_action("quote", "quote", {}, name("forsale1"), name("bidder"), name("ref")),
+        transfer("buy_saleprice", name("bidder"), wax(5), "sp:forsale1," + keys + ",ref"),
+        contract_action("sell", "sell", {name("forsale2")}, name("forsale2"), wax(10), name("seller"), std::string("")),
+        contract_action("cancel", "cancel", {name("seller")}, name("forsale2"), key, key),
+        contract_action("sell", "sell", {name("forsale3")}, name("forsale3"), wax(10), name("seller"), std::string("")),
+        contract_action("screener", "screener", {contract}, name("forsale3"), uint8_t(1)),
+        contract_action("remove", "remove", {contract}, name("forsale3")),
+        transfer("make_account", name("buyer"), wax(100), "mk:newaccount12," + keys),
+        contract_action("sell", "sell", {name("forsale4")}, name("forsale4"), wax(10), name("seller"), std::string("")),
+        contract_action("vote", "vote", {name("voter")}, name("forsale4"), name("voter")),
+        contract_action("vote (repeat)", "vote", {name("voter")}, name("forsale4"), name("voter")),
+        transfer("buy_saleprice (short)", name("buyer"), wax(1), "sp:forsale4," + keys),
+        contract_action("sell", "sell", {name("forsale5")}, name("forsale5"), wax(10), name("seller"), std::string("Flip me")),
+        transfer("buy_relist", name("buyer"), wax(10), "rl:forsale5,15.5,ref"),
+    };
+}
+
+// System tables read by the contract
+void seed()
+{
+    // RAM market: 64 GiB of RAM against 10M WAX
+    eosio::exchange_state market;
+    market.supply = asset(10000000000ll * 10000, symbol("RAMCORE", 4));
+    market.base = eosio::connector{asset(64ll * 1024 * 1024 * 1024, symbol("RAM", 0)), 0.5};
+    market.quote = eosio::connector{wax(10000000), 0.5};
+
+    const auto data = eosio::pack(market);
+    state.primary.store(table_id{name("eosio").value, name("eosio").value, name("rammarket").value}, market.primary_key(), name("eosio").value, data.data(), data.size());
+}
+
+cost_profile run(const scripted_action &act)
+{
+    cost_profile profile;
+
+    // Failed actions are rolled back like on chain
+    const chain_state before = state;
+
+    receiver = contract;
+    action_data = act.data;
+    authorizers = act.auths;
+    current = &profile;
+    dispatched.clear();
+
+    try
+    {
+        eosio::apply(contract.value, act.code.value, act.action_name.value);
+    }
+    catch (const action_exit &)
+    {
+    }
+    catch (const assert_failure &e)
+    {
+        profile.error = e.what();
+        state = before;
+    }
+
+    current = nullptr;
+    now_us += 1000000;
+
+    // Inline actions of a failed action are never sent
+    if (!dispatched.empty())
+    {
+        entry_traces[dispatched].failed += profile.error.empty() ? 0 : 1;
+        entry_traces[dispatched].inline_actions += profile.error.empty() ? profile.inline_actions.size() : 0;
+    }
+
+    return profile;
+}
+
+// ---------------------------------------------------------------
+// Reports
+// ---------------------------------------------------------------
+
+typedef std::vector<std::pair<std::string, cost_profile>> profiles;
+
+void print_table(const profiles &results)
+{
+    for (const auto &result : results)
+    {
+        const cost_profile &profile = result.second;
+
+        std::cout << result.first;
+        if (!profile.error.empty())
+            std::cout << "  FAILED: " << profile.error;
+        std::cout << "\n";
+
+        for (const auto &call : profile.calls)
+        {
+            std::cout << "    " << std::left << std::setw(28) << call.first
+                      << std::right << std::setw(6) << call.second
+                      << std::setw(10) << profile.bytes.at(call.first) << " B\n";
+        }
+
+        std::cout << "    " << std::left << std::setw(28) << "inline actions" << std::right << std::setw(6) << profile.inline_actions.size() << "\n";
+        std::cout << "    " << std::left << std::setw(28) << "ram delta" << std::right << std::setw(16) << profile.ram_delta << " B\n\n";
+    }
+}
+
+std::string json_escape(const std::string &s)
+{
+    std::string out;
+    for (char c : s)
+    {
+        if (c == '"' || c == '\\')
+            out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+void write_json(const profiles &results, std::ostream &out)
+{
+    out << "[\n";
+    for (size_t lp = 0; lp < results.size(); ++lp)
+    {
+        const cost_profile &profile = results[lp].second;
+
+        out << "  {\"action\": \"" << results[lp].first << "\", \"error\": \"" << json_escape(profile.error) << "\", \"ram_delta\": " << profile.ram_delta << ",\n";
+
+        out << "   \"intrinsics\": {";
+        for (auto itr = profile.calls.begin(); itr != profile.calls.end(); ++itr)
+        {
+            out << (itr == profile.calls.begin() ? "" : ", ") << "\"" << itr->first << "\": {\"calls\": " << itr->second << ", \"bytes\": " << profile.bytes.at(itr->first) << "}";
+        }
+        out << "},\n";
+
+        out << "   \"inline_actions\": [";
+        for (size_t ia = 0; ia < profile.inline_actions.size(); ++ia)
+        {
+            out << (ia == 0 ? "" : ", ") << "\"" << profile.inline_actions[ia] << "\"";
+        }
+        out << "]}" << (lp + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "]\n";
+}
+
+// Entry points and failed check call sites, busiest first
+void write_trace(std::ostream &out)
+{
+    std::vector<std::pair<std::string, entry_trace>> entries(entry_traces.begin(), entry_traces.end());
+    std::stable_sort(entries.begin(), entries.end(), [](const auto &a, const auto &b) { return a.second.dispatches > b.second.dispatches; });
+
+    out << std::left << std::setw(32) << "entry point" << std::right << std::setw(12) << "dispatches" << std::setw(10) << "failed" << std::setw(10) << "inline" << "\n";
+    for (const auto &entry : entries)
+    {
+        out << std::left << std::setw(32) << entry.first << std::right << std::setw(12) << entry.second.dispatches
+            << std::setw(10) << entry.second.failed << std::setw(10) << entry.second.inline_actions << "\n";
+    }
+
+    std::vector<std::pair<std::string, uint64_t>> sites(failed_sites.begin(), failed_sites.end());
+    std::stable_sort(sites.begin(), sites.end(), [](const auto &a, const auto &b) { return a.second > b.second; });
+
+    out << "\n" << std::left << std::setw(8) << "failed" << "call site\n";
+    for (const auto &site : sites)
+    {
+        out << std::left << std::setw(8) << site.second << site.first << "\n";
+    }
+}
+
+// Golden file lines: "<step> <action> <counter> <value>"
+std::map<std::string, uint64_t> golden_counters(const profiles &results)
+{
+    std::map<std::string, uint64_t> counters;
+    for (size_t lp = 0; lp < results.size(); ++lp)
+    {
+        std::ostringstream step;
+        step << std::setw(2) << std::setfill('0') << lp << " " << results[lp].first;
+
+        for (const auto &call : results[lp].second.calls)
+            counters[step.str() + " " + call.first] = call.second;
+        counters[step.str() + " inline_actions"] = results[lp].second.inline_actions.size();
+        counters[step.str() + " failed"] = results[lp].second.error.empty() ? 0 : 1;
+    }
+    return counters;
+}
+
+// Returns false if any counter is new or higher than in the golden file
+bool check_golden(const profiles &results, const std::string &path)
+{
+    std::ifstream in(path);
+    if (!in)
+    {
+        std::cerr << "Cannot read golden file " << path << ". Run with --update to create it.\n";
+        return false;
+    }
+
+    std::map<std::string, uint64_t> golden;
+    std::string line;
+    while (std::getline(in, line))
+    {
+        const size_t split = line.rfind(' ');
+        if (split != std::string::npos)
+            golden[line.substr(0, split)] = std::stoull(line.substr(split + 1));
+    }
+
+    bool ok = true;
+    for (const auto &counter : golden_counters(results))
+    {
+        auto itr = golden.find(counter.first);
+        const uint64_t expected = itr == golden.end() ? 0 : itr->second;
+        if (counter.second > expected)
+        {
+            std::cerr << "Cost regression: " << counter.first << " " << expected << " -> " << counter.second << "\n";
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+void write_golden(const profiles &results, const std::string &path)
+{
+    std::ofstream out(path);
+    for (const auto &counter : golden_counters(results))
+        out << counter.first << " " << counter.second << "\n";
+}
+
+} // namespace profiler
+
+int main(int argc, char **argv)
+{
+    std::string json_path, report_path, golden_path;
+    bool update = false;
+
+    for (int lp = 1; lp < argc; ++lp)
+    {
+        const std::string arg = argv[lp];
+        if (arg == "--json" && lp + 1 < argc)
+            json_path = argv[++lp];
+        else if (arg == "--report" && lp + 1 < argc)
+            report_path = argv[++lp];
+        else if (arg == "--golden" && lp + 1 < argc)
+            golden_path = argv[++lp];
+        else if (arg == "--update")
+            update = true;
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [--json <file>] [--report <file>] [--golden <file> [--update]]\n";
+            return 2;
+        }
+    }
+
+    profiler::install();
+    profiler::seed();
+
+    profiler::profiles results;
+    for (const auto &act : profiler::script())
+        results.emplace_back(act.label, profiler::run(act));
+
+    profiler::print_table(results);
+    profiler::write_trace(std::cout);
+
+    if (!json_path.empty())
+    {
+        std::ofstream out(json_path);
+        profiler::write_json(results, out);
+    }
+
+    if (!report_path.empty())
+    {
+        std::ofstream out(report_path);
+        profiler::write_trace(out);
+    }
+
+    if (!golden_path.empty())
+    {
+        if (update)
+            profiler::write_golden(results, golden_path);
+        else if (!profiler::check_golden(results, golden_path))
+            return 1;
+    }
+
+    return 0;
+}
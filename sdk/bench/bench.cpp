@@ -0,0 +1,147 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+
+#include "nameswaps_sdk.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+using namespace nameswaps::sdk;
+
+// Public key in the memo format (any base58 key of the right length decodes)
+static const char *const TEST_KEY = "EOS6MRyAjQq8ud7hVNYcfnVPJqcVpscN5So8BhtHuGYqET5GDW5CV";
+
+// Random account name of the given length from the name alphabet (no dots)
+static std::string random_name(std::mt19937_64 &rng, size_t length)
+{
+    static const char chars[] = "abcdefghijklmnopqrstuvwxyz12345";
+
+    std::string name;
+    for (size_t i = 0; i < length; ++i)
+    {
+        name += chars[rng() % (sizeof(chars) - 1)];
+    }
+
+    return name;
+}
+
+// Mix of valid purchases and the mistakes the backend has to catch
+static std::vector<purchase_intent> make_intents(size_t count)
+{
+
+    std::mt19937_64 rng(42);
+    std::vector<purchase_intent> intents;
+    intents.reserve(count);
+
+    std::string bad_key = TEST_KEY;
+    bad_key[10] = '0';
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        switch (rng() % 8)
+        {
+        case 0:
+        case 1:
+        case 2:
+            intents.push_back({make_memo("sp:", random_name(rng, 1 + rng() % 12), TEST_KEY, TEST_KEY, "nameswapsref"), 100000, 100000});
+            break;
+        case 3:
+            intents.push_back({make_memo("cn:", random_name(rng, 8) + ".x", TEST_KEY, TEST_KEY), 37000, 0});
+            break;
+        case 4:
+            intents.push_back({make_memo("mk:", random_name(rng, 12), TEST_KEY, TEST_KEY), 2000000, 1500000});
+            break;
+        case 5:
+            intents.push_back({make_memo("sp:", random_name(rng, 8), bad_key, TEST_KEY), 100000, 100000});
+            break;
+        case 6:
+            intents.push_back({make_memo("cn:", random_name(rng, 9) + ".y", TEST_KEY, TEST_KEY), 1, 0});
+            break;
+        default:
+            intents.push_back({make_memo("sp:", random_name(rng, 6) + "A", TEST_KEY, TEST_KEY), 100000, 100000});
+            break;
+        }
+    }
+
+    return intents;
+}
+
+int main(int argc, char **argv)
+{
+
+    size_t count = 200000;
+    unsigned max_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--intents") == 0 && i + 1 < argc)
+        {
+            count = strtoull(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            max_threads = std::max(1, atoi(argv[++i]));
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--intents N] [--threads N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    const std::vector<purchase_intent> intents = make_intents(count);
+
+    // Single threaded reference
+    auto start = std::chrono::steady_clock::now();
+    std::vector<intent_result> reference;
+    reference.reserve(intents.size());
+    for (const auto &intent : intents)
+    {
+        reference.push_back(check_intent(intent));
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    size_t accepted = 0;
+    for (const auto &result : reference)
+    {
+        accepted += result.ok;
+    }
+
+    printf("%zu intents, %zu accepted\n\n", intents.size(), accepted);
+    printf("%-10s %12s %14s %9s\n", "threads", "ms", "intents/s", "speedup");
+    printf("%-10s %12.1f %14.0f %9s\n", "serial", seconds * 1e3, intents.size() / seconds, "1.00");
+
+    const double serial_seconds = seconds;
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2)
+    {
+        thread_pool pool(threads);
+
+        start = std::chrono::steady_clock::now();
+        const std::vector<intent_result> results = check_intents(pool, intents);
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        // The batch must agree with the serial checks
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            if (results[i].ok != reference[i].ok || results[i].error != reference[i].error || results[i].price != reference[i].price)
+            {
+                fprintf(stderr, "Mismatch at intent %zu: %s\n", i, intents[i].memo.c_str());
+                return 1;
+            }
+        }
+
+        printf("%-10u %12.1f %14.0f %9.2f\n", threads, seconds * 1e3, intents.size() / seconds, serial_seconds / seconds);
+
+        if (threads < max_threads && threads * 2 > max_threads)
+        {
+            threads = max_threads / 2;
+        }
+    }
+
+    return 0;
+}
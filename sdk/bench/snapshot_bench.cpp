@@ -0,0 +1,113 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+
+#include "nameswaps_sdk.hpp"
+#include "nameswaps_snapshot.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+using namespace nameswaps;
+
+// Random account name from the name alphabet (no dots)
+static std::string random_name(std::mt19937_64 &rng)
+{
+    static const char chars[] = "abcdefghijklmnopqrstuvwxyz12345";
+
+    std::string name;
+    for (size_t i = 0, length = 4 + rng() % 9; i < length; ++i)
+    {
+        name += chars[rng() % (sizeof(chars) - 1)];
+    }
+
+    return name;
+}
+
+static double elapsed_ms(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char **argv)
+{
+
+    size_t rows = 500000;
+    std::string path = "snapshot_bench.snap";
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--rows") == 0 && i + 1 < argc)
+        {
+            rows = strtoull(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+        {
+            path = argv[++i];
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--rows N] [--out file.snap]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // get_table_rows style JSON for the accounts and extras tables
+    std::mt19937_64 rng(7);
+    std::string accounts_json = "{\"rows\":[";
+    std::string extras_json = "{\"rows\":[";
+    for (size_t i = 0; i < rows; ++i)
+    {
+        const std::string name = random_name(rng);
+        const std::string sep = i ? "," : "";
+        accounts_json += sep + "{\"account4sale\":\"" + name + "\",\"saleprice\":\"" + std::to_string(1 + rng() % 1000) + ".00000000 WAX\",\"paymentaccnt\":\"" + random_name(rng) + "\"}";
+        extras_json += sep + "{\"account4sale\":\"" + name + "\",\"screened\":" + (rng() % 2 ? "true" : "false") + ",\"numberofvotes\":" + std::to_string(rng() % 100) + ",\"last_voter\":\"" + random_name(rng) + "\",\"message\":\"Great name for a \\\"project\\\"\"}";
+    }
+    accounts_json += "],\"more\":false}";
+    extras_json += "],\"more\":false}";
+
+    printf("%zu rows, %.1f MB of JSON\n\n", rows, (accounts_json.size() + extras_json.size()) / 1e6);
+
+    // Parse the JSON, as every offline tool does at startup today
+    auto start = std::chrono::steady_clock::now();
+    auto accounts = snapshot::accounts_from_json(accounts_json);
+    auto extras = snapshot::extras_from_json(extras_json);
+    const double parse_ms = elapsed_ms(start);
+
+    start = std::chrono::steady_clock::now();
+    snapshot::write_snapshot(path, std::move(accounts), std::move(extras), {}, {});
+    const double write_ms = elapsed_ms(start);
+
+    // Map the snapshot and scan a column
+    start = std::chrono::steady_clock::now();
+    snapshot::reader snap(path);
+    const double open_ms = elapsed_ms(start);
+
+    start = std::chrono::steady_clock::now();
+    int64_t listed_value = 0;
+    for (const int64_t amount : snap.accounts().saleprice_amount)
+    {
+        listed_value += amount;
+    }
+    const double scan_ms = elapsed_ms(start);
+
+    start = std::chrono::steady_clock::now();
+    size_t found = 0;
+    for (size_t i = 0; i < snap.extras().size(); i += 97)
+    {
+        found += snap.accounts().find(snap.extras().account4sale[i]) != snapshot::npos;
+    }
+    const double find_ms = elapsed_ms(start);
+
+    printf("%-28s %10.2f ms\n", "parse JSON", parse_ms);
+    printf("%-28s %10.2f ms\n", "write snapshot", write_ms);
+    printf("%-28s %10.3f ms (%zu bytes)\n", "open snapshot", open_ms, snap.file_size());
+    printf("%-28s %10.3f ms (total %lld)\n", "scan saleprice column", scan_ms, (long long)listed_value);
+    printf("%-28s %10.3f ms (%zu found)\n", "binary search 1/97 of rows", find_ms, found);
+
+    return 0;
+}
@@ -0,0 +1,205 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+
+#include "nameswaps_sdk.hpp"
+#include "nameswaps_watch.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+using namespace nameswaps;
+
+// Random string from the name alphabet (no dots)
+static std::string random_name(std::mt19937_64 &rng, size_t length)
+{
+    static const char chars[] = "abcdefghijklmnopqrstuvwxyz12345";
+
+    std::string name;
+    for (size_t i = 0; i < length; ++i)
+    {
+        name += chars[rng() % (sizeof(chars) - 1)];
+    }
+
+    return name;
+}
+
+// Price between 1 and 100000 tokens, log-uniform (8 decimals)
+static int64_t random_price(std::mt19937_64 &rng)
+{
+    return int64_t(std::pow(10.0, 8.0 + 5.0 * double(rng() % 100000) / 100000.0));
+}
+
+// Mix of exact names, premium suffixes, prefixes and catch-all alerts with a low ceiling
+static std::vector<watch::watchlist> make_watchlists(size_t count)
+{
+
+    std::mt19937_64 rng(11);
+    std::vector<watch::watchlist> watchlists(count);
+
+    for (auto &w : watchlists)
+    {
+        const unsigned kind = rng() % 200;
+        if (kind < 90)
+        {
+            w.pattern = random_name(rng, 4 + rng() % 9);
+        }
+        else if (kind < 130)
+        {
+            w.pattern = "*." + random_name(rng, 1 + rng() % 2);
+            w.max_price = random_price(rng);
+        }
+        else if (kind < 199)
+        {
+            w.pattern = random_name(rng, 2 + rng() % 3) + "*";
+            w.min_length = uint8_t(1 + rng() % 6);
+            w.max_length = uint8_t(w.min_length + rng() % 7);
+        }
+        else
+        {
+            w.pattern = "*";
+            w.min_length = uint8_t(1 + rng() % 4);
+            w.max_length = uint8_t(w.min_length + rng() % 2);
+            w.max_price = int64_t(1 + rng() % 20) * 100000000;
+        }
+
+        if (rng() % 4 == 0)
+        {
+            w.events = uint8_t(1 + rng() % 7);
+        }
+    }
+
+    return watchlists;
+}
+
+static std::vector<watch::event> make_events(size_t count)
+{
+
+    std::mt19937_64 rng(12);
+    std::vector<watch::event> events(count);
+
+    for (auto &e : events)
+    {
+        const std::string account = rng() % 3 == 0 ? random_name(rng, 1 + rng() % 9) + "." + random_name(rng, 1 + rng() % 2) : random_name(rng, 1 + rng() % 12);
+        sdk::string_to_name(account, e.account);
+        e.kind = watch::event_kind(1 << (rng() % 3));
+        e.price = random_price(rng);
+    }
+
+    return events;
+}
+
+int main(int argc, char **argv)
+{
+
+    size_t num_watchlists = 1000000;
+    size_t num_events = 200000;
+    size_t num_checked = 500;
+    unsigned max_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--watchlists") == 0 && i + 1 < argc)
+            num_watchlists = strtoull(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--events") == 0 && i + 1 < argc)
+            num_events = strtoull(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--check") == 0 && i + 1 < argc)
+            num_checked = strtoull(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            max_threads = std::max(1, atoi(argv[++i]));
+        else
+        {
+            fprintf(stderr, "usage: %s [--watchlists N] [--events N] [--check N] [--threads N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    const std::vector<watch::watchlist> watchlists = make_watchlists(num_watchlists);
+    const std::vector<watch::event> events = make_events(num_events);
+
+    auto start = std::chrono::steady_clock::now();
+    const watch::matcher matcher(watchlists);
+    const double build_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    printf("%zu watchlists compiled in %.1f ms (%zu nodes, %.1f MB)\n", watchlists.size(), build_ms, matcher.nodes(), matcher.memory_bytes() / 1e6);
+
+    // Re-evaluating every watchlist per event, as the alerting service does today. The matcher must agree
+    num_checked = std::min(num_checked, events.size());
+    std::vector<uint32_t> expected, found;
+    double naive_us = 0;
+    for (size_t i = 0; i < num_checked; ++i)
+    {
+        start = std::chrono::steady_clock::now();
+        expected.clear();
+        for (size_t w = 0; w < watchlists.size(); ++w)
+        {
+            if (watch::matches(watchlists[w], events[i]))
+            {
+                expected.push_back(uint32_t(w));
+            }
+        }
+        naive_us += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+        found.clear();
+        matcher.match(events[i], found);
+        std::sort(found.begin(), found.end());
+        if (found != expected)
+        {
+            fprintf(stderr, "Mismatch at event %zu (%s): %zu matches, expected %zu\n", i, sdk::name_to_string(events[i].account).c_str(), found.size(), expected.size());
+            return 1;
+        }
+    }
+    if (num_checked > 0)
+    {
+        printf("re-evaluating every watchlist: %.1f us per event (%zu events checked against the matcher)\n", naive_us / num_checked, num_checked);
+    }
+
+    printf("\n%-10s %12s %14s %10s %10s %10s %12s\n", "threads", "ms", "events/s", "p50 us", "p99 us", "max us", "matches");
+
+    std::vector<double> latency_us(events.size());
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2)
+    {
+        sdk::thread_pool pool(threads);
+        std::vector<size_t> match_counts(events.size());
+
+        start = std::chrono::steady_clock::now();
+        pool.parallel_for(events.size(), 64, [&](size_t begin, size_t end) {
+            std::vector<uint32_t> matches;
+            for (size_t i = begin; i < end; ++i)
+            {
+                const auto event_start = std::chrono::steady_clock::now();
+                matches.clear();
+                matcher.match(events[i], matches);
+                latency_us[i] = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - event_start).count();
+                match_counts[i] = matches.size();
+            }
+        });
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        size_t total = 0;
+        for (const size_t n : match_counts)
+        {
+            total += n;
+        }
+
+        std::vector<double> sorted = latency_us;
+        std::sort(sorted.begin(), sorted.end());
+        auto percentile = [&](double p) { return sorted.empty() ? 0.0 : sorted[std::min(sorted.size() - 1, size_t(p * sorted.size()))]; };
+
+        printf("%-10u %12.1f %14.0f %10.2f %10.2f %10.2f %12zu\n", threads, seconds * 1e3, events.size() / seconds,
+               percentile(0.5), percentile(0.99), sorted.empty() ? 0.0 : sorted.back(), total);
+
+        if (threads < max_threads && threads * 2 > max_threads)
+        {
+            threads = max_threads / 2;
+        }
+    }
+
+    return 0;
+}
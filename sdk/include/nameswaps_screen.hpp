@@ -0,0 +1,129 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include "nameswaps_sdk.hpp"
+
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Offline screening of listed accounts against dumps of their chain state.
+//
+// sell() leaves a listed account with exactly two permissions:
+//   owner    threshold 1, contract@owner, no keys or waits
+//   active   threshold 1, contract@active, no keys or waits (parent owner)
+// A listing passes screening if its account is still in that state, has no linked actions, no
+// deferred transaction sent, paid for or authorized by it, and at least the minimum free RAM.
+namespace nameswaps
+{
+namespace screen
+{
+
+// Reasons a listing fails screening (bit mask)
+enum reason : uint32_t
+{
+    no_state = 1 << 0,         // Account is not in the state dump
+    extra_permission = 1 << 1, // Permission other than owner and active
+    owner_changed = 1 << 2,    // Owner is not contract@owner
+    active_changed = 1 << 3,   // Active is not contract@active under owner
+    linked_actions = 1 << 4,   // linkauth to one of the account's permissions
+    deferred = 1 << 5,         // Deferred transaction sent, paid for or authorized by the account
+    low_ram = 1 << 6,          // Free RAM below the minimum
+};
+
+// Comma separated names of the reasons in a mask
+std::string reason_names(uint32_t reasons);
+
+// Permission from get_account
+struct permission
+{
+    uint64_t perm_name;
+    uint64_t parent;
+    uint32_t threshold;
+
+    // Number of keys and waits in the authority
+    uint32_t num_keys;
+    uint32_t num_waits;
+
+    // Accounts in the authority (actor, permission, weight)
+    struct account_weight
+    {
+        uint64_t actor;
+        uint64_t permission;
+        uint16_t weight;
+    };
+    std::vector<account_weight> accounts;
+
+    // Number of linked actions
+    uint32_t num_links;
+};
+
+// Chain state of an account from get_account
+struct account_state
+{
+    uint64_t account;
+    int64_t ram_quota;
+    int64_t ram_usage;
+    std::vector<permission> permissions;
+};
+
+// Listing to screen and its current screening status
+struct listing
+{
+    uint64_t account4sale;
+    bool screened;
+};
+
+// Screening rules
+struct rules
+{
+    // Contract account the listings are held by
+    uint64_t contract;
+
+    // Minimum free RAM in bytes (ram_quota - ram_usage). Unlimited RAM (-1) always passes
+    int64_t min_free_ram = 0;
+};
+
+// Screening decision for a listing
+struct decision
+{
+    uint64_t account4sale;
+
+    // screener option (1 = screened, 0 = not screened)
+    uint8_t option;
+
+    // Why the listing failed (0 if it passed)
+    uint32_t reasons;
+
+    // Does the option differ from the listing's current status?
+    bool changed;
+};
+
+// Screen one account. deferred_accounts is sorted and holds every account involved in a deferred transaction
+uint32_t screen_account(const rules &rules, const account_state *state, const std::vector<uint64_t> &deferred_accounts);
+
+// Screen every listing across the pool. Decisions are in account order whatever the number of threads
+std::vector<decision> screen_listings(sdk::thread_pool &pool,
+                                      const rules &rules,
+                                      std::vector<listing> listings,
+                                      const std::vector<account_state> &states,
+                                      const std::vector<uint64_t> &deferred_accounts);
+
+// Parse get_account responses (a JSON array, or objects one after another) across the pool. Result is sorted by account.
+// Throws std::runtime_error on failure
+std::vector<account_state> account_states_from_json(sdk::thread_pool &pool, std::string_view json);
+
+// Accounts that send, pay for or authorize a transaction in get_scheduled_transactions responses (json=true).
+// Result is sorted and unique. Throws std::runtime_error on failure
+std::vector<uint64_t> deferred_accounts_from_json(std::string_view json);
+
+// screenbatch actions for the decisions, at most batch_size accounts each, one JSON action per line.
+// Only changed decisions are included unless all is set
+std::string screenbatch_actions(uint64_t contract, const std::vector<decision> &decisions, size_t batch_size, bool all);
+
+} // namespace screen
+} // namespace nameswaps
@@ -0,0 +1,106 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include <stdint.h>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace nameswaps
+{
+namespace sdk
+{
+
+// A transfer to the contract that the backend is about to ask a user to sign
+struct purchase_intent
+{
+    // Transfer memo
+    std::string memo;
+
+    // Transfer quantity in the smallest token unit
+    int64_t quantity;
+
+    // Listing price (sp:) or new account fee (mk:) from the tables or accountquote. 0 skips the price check
+    int64_t price;
+};
+
+// Outcome of checking a purchase intent
+struct intent_result
+{
+    // Would the contract accept the memo and quantity?
+    bool ok;
+
+    // Contract error message if not
+    std::string error;
+
+    // Name of account to buy (encoded as eosio::name)
+    uint64_t account;
+
+    // Price the contract will charge in the smallest token unit
+    int64_t price;
+};
+
+// Encode an account name with the eosio::name rules. Returns false if the name is not valid
+bool string_to_name(std::string_view str, uint64_t &value);
+
+// Decode an account name (eosio::name::to_string)
+std::string name_to_string(uint64_t value);
+
+// Check a public key decodes as it would in the contract. Returns false if it does not
+bool valid_public_key(std::string_view key);
+
+// Build a cn:, sp: or mk: transfer memo (referrer is optional)
+std::string make_memo(std::string_view code, std::string_view account_name, std::string_view owner_key, std::string_view active_key, std::string_view referrer = std::string_view());
+
+// Check a purchase intent with the contract's memo grammar, name and key rules and custom prices
+intent_result check_intent(const purchase_intent &intent);
+
+// Fixed pool of worker threads for batch checks
+class thread_pool
+{
+
+public:
+    // Start the workers (0 = one per core)
+    explicit thread_pool(unsigned threads = 0);
+    ~thread_pool();
+
+    thread_pool(const thread_pool &) = delete;
+    thread_pool &operator=(const thread_pool &) = delete;
+
+    // Number of workers
+    unsigned size() const { return static_cast<unsigned>(workers.size()); }
+
+    // Call fn(begin, end) over [0, count) in chunks of grain items and wait for all chunks
+    void parallel_for(size_t count, size_t grain, const std::function<void(size_t, size_t)> &fn);
+
+private:
+    // Worker loop
+    void run();
+
+    std::vector<std::thread> workers;
+    std::mutex lock;
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    // Current job
+    const std::function<void(size_t, size_t)> *job = nullptr;
+    size_t job_count = 0;
+    size_t job_grain = 1;
+    size_t next_chunk = 0;
+    size_t chunks_left = 0;
+    uint64_t generation = 0;
+    bool stopping = false;
+};
+
+// Check many purchase intents across the pool. Results are in intent order
+std::vector<intent_result> check_intents(thread_pool &pool, const std::vector<purchase_intent> &intents);
+
+} // namespace sdk
+} // namespace nameswaps
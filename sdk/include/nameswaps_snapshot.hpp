@@ -0,0 +1,224 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Column-wise binary snapshot of the accounts, extras, bids and stats tables.
+//
+// Layout (little endian, every section 8 byte aligned):
+//   header      magic "NSWPSNAP", format version, number of tables
+//   directory   per table: table name, row count, number of columns, offset of its column directory
+//   columns     per column: column type, offset, byte size
+//   data        fixed width columns are plain arrays. String columns are row count + 1 offsets into a blob
+//
+// Rows are sorted by primary key, so a listing is found with a binary search on the first column.
+namespace nameswaps
+{
+namespace snapshot
+{
+
+// Current snapshot format
+constexpr uint32_t FORMAT_VERSION = 1;
+
+// Column types
+enum class column_type : uint32_t
+{
+    u8 = 1,
+    u16 = 2,
+    u64 = 3,
+    i64 = 4,
+    string = 5,
+};
+
+// Asset as stored on chain (amount and eosio::symbol value)
+struct asset
+{
+    int64_t amount;
+    uint64_t symbol;
+};
+
+// Rows of the contract tables (same fields as accounttable, extrastable, bidstable and statstable)
+struct account_row
+{
+    uint64_t account4sale;
+    asset saleprice;
+    uint64_t paymentaccnt;
+};
+
+struct extras_row
+{
+    uint64_t account4sale;
+    bool screened;
+    uint64_t numberofvotes;
+    uint64_t last_voter;
+    std::string message;
+};
+
+struct bids_row
+{
+    uint64_t account4sale;
+    uint16_t bidaccepted;
+    asset bidprice;
+    uint64_t bidder;
+};
+
+struct stats_row
+{
+    uint64_t index;
+    uint64_t num_listed;
+    uint64_t num_purchased;
+    asset tot_sales;
+    asset tot_fees;
+};
+
+// Zero-copy view of a fixed width column
+template <typename T>
+class column_view
+{
+
+public:
+    column_view() = default;
+    column_view(const T *data, size_t size) : data(data), count(size) {}
+
+    size_t size() const { return count; }
+    T operator[](size_t row) const { return data[row]; }
+    const T *begin() const { return data; }
+    const T *end() const { return data + count; }
+
+private:
+    const T *data = nullptr;
+    size_t count = 0;
+};
+
+// Zero-copy view of a string column
+class string_column_view
+{
+
+public:
+    string_column_view() = default;
+    string_column_view(const uint32_t *offsets, const char *blob, size_t size) : offsets(offsets), blob(blob), count(size) {}
+
+    size_t size() const { return count; }
+    std::string_view operator[](size_t row) const { return std::string_view(blob + offsets[row], offsets[row + 1] - offsets[row]); }
+
+private:
+    const uint32_t *offsets = nullptr;
+    const char *blob = nullptr;
+    size_t count = 0;
+};
+
+// Row index of a primary key in a sorted key column, or npos
+size_t find_key(const column_view<uint64_t> &keys, uint64_t key);
+
+constexpr size_t npos = size_t(-1);
+
+struct accounts_view
+{
+    column_view<uint64_t> account4sale;
+    column_view<int64_t> saleprice_amount;
+    column_view<uint64_t> saleprice_symbol;
+    column_view<uint64_t> paymentaccnt;
+
+    size_t size() const { return account4sale.size(); }
+    size_t find(uint64_t account) const { return find_key(account4sale, account); }
+    asset saleprice(size_t row) const { return {saleprice_amount[row], saleprice_symbol[row]}; }
+};
+
+struct extras_view
+{
+    column_view<uint64_t> account4sale;
+    column_view<uint8_t> screened;
+    column_view<uint64_t> numberofvotes;
+    column_view<uint64_t> last_voter;
+    string_column_view message;
+
+    size_t size() const { return account4sale.size(); }
+    size_t find(uint64_t account) const { return find_key(account4sale, account); }
+};
+
+struct bids_view
+{
+    column_view<uint64_t> account4sale;
+    column_view<uint16_t> bidaccepted;
+    column_view<int64_t> bidprice_amount;
+    column_view<uint64_t> bidprice_symbol;
+    column_view<uint64_t> bidder;
+
+    size_t size() const { return account4sale.size(); }
+    size_t find(uint64_t account) const { return find_key(account4sale, account); }
+    asset bidprice(size_t row) const { return {bidprice_amount[row], bidprice_symbol[row]}; }
+};
+
+struct stats_view
+{
+    column_view<uint64_t> index;
+    column_view<uint64_t> num_listed;
+    column_view<uint64_t> num_purchased;
+    column_view<int64_t> tot_sales_amount;
+    column_view<uint64_t> tot_sales_symbol;
+    column_view<int64_t> tot_fees_amount;
+    column_view<uint64_t> tot_fees_symbol;
+
+    size_t size() const { return index.size(); }
+    size_t find(uint64_t key) const { return find_key(index, key); }
+};
+
+// Write a snapshot (rows are sorted by primary key). Throws std::runtime_error on failure
+void write_snapshot(const std::string &path,
+                    std::vector<account_row> accounts,
+                    std::vector<extras_row> extras,
+                    std::vector<bids_row> bids,
+                    std::vector<stats_row> stats);
+
+// Read-only memory map of a snapshot. Pages are shared by every process mapping the same file
+class reader
+{
+
+public:
+    // Map and validate a snapshot. Throws std::runtime_error on failure
+    explicit reader(const std::string &path);
+    ~reader();
+
+    reader(const reader &) = delete;
+    reader &operator=(const reader &) = delete;
+
+    // Table views (empty if the table is not in the snapshot)
+    const accounts_view &accounts() const { return accounts_table; }
+    const extras_view &extras() const { return extras_table; }
+    const bids_view &bids() const { return bids_table; }
+    const stats_view &stats() const { return stats_table; }
+
+    // Size of the mapped file in bytes
+    size_t file_size() const { return length; }
+
+private:
+    // Fixed width column of a table (checks type and size)
+    template <typename T>
+    column_view<T> column(uint64_t table, uint32_t index, column_type type) const;
+
+    // String column of a table
+    string_column_view string_column(uint64_t table, uint32_t index) const;
+
+    const uint8_t *base = nullptr;
+    size_t length = 0;
+
+    accounts_view accounts_table;
+    extras_view extras_table;
+    bids_view bids_table;
+    stats_view stats_table;
+};
+
+// Convert get_table_rows JSON (one or more responses, or bare row arrays) to rows. Throws std::runtime_error on failure
+std::vector<account_row> accounts_from_json(std::string_view json);
+std::vector<extras_row> extras_from_json(std::string_view json);
+std::vector<bids_row> bids_from_json(std::string_view json);
+std::vector<stats_row> stats_from_json(std::string_view json);
+
+} // namespace snapshot
+} // namespace nameswaps
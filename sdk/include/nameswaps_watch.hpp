@@ -0,0 +1,130 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include <stdint.h>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Watchlist matching for price alerts.
+//
+// A watchlist is a name pattern with optional filters:
+//   dragon     exact name
+//   drag*      names starting with drag
+//   *.x        names ending with .x
+//   *          every name
+// plus a name length range, a price ceiling and the events it wants (sell, update, proposebid).
+//
+// The patterns are compiled into two tries over the 32 name characters, one over the names and one
+// over the reversed names for suffix patterns. Every trie node that ends a pattern holds the
+// watchlists of that pattern sorted by price ceiling, so an event walks at most 2 x 13 nodes and
+// stops reading each node's watchlists at the first ceiling below its price.
+namespace nameswaps
+{
+namespace watch
+{
+
+// Contract actions a watchlist can follow (bit mask)
+enum event_kind : uint8_t
+{
+    sell = 1,
+    update = 2,
+    proposebid = 4,
+    all_events = sell | update | proposebid,
+};
+
+struct watchlist
+{
+    // Name pattern (see above)
+    std::string pattern;
+
+    // Name length range
+    uint8_t min_length = 1;
+    uint8_t max_length = 13;
+
+    // Highest price in the smallest token unit
+    int64_t max_price = std::numeric_limits<int64_t>::max();
+
+    // Events to match (event_kind mask)
+    uint8_t events = all_events;
+};
+
+// A sell, update or proposebid
+struct event
+{
+    event_kind kind;
+
+    // Account for sale (encoded as eosio::name)
+    uint64_t account;
+
+    // Sale price, new price or bid in the smallest token unit
+    int64_t price;
+};
+
+// Compiled watchlists. Matching is read-only, so one matcher can be shared by any number of threads
+class matcher
+{
+
+public:
+    // Compile the watchlists. Throws std::invalid_argument on a bad pattern
+    explicit matcher(const std::vector<watchlist> &watchlists);
+
+    // Append the indices of the watchlists matching the event (in no particular order)
+    void match(const event &e, std::vector<uint32_t> &matches) const;
+
+    // Number of trie nodes and bytes used by the compiled watchlists
+    size_t nodes() const { return forward.labels.size() + reverse.labels.size(); }
+    size_t memory_bytes() const;
+
+private:
+    // Watchlist at a pattern's trie node
+    struct entry
+    {
+        int64_t max_price;
+        uint32_t watchlist;
+        uint16_t lengths; // Bit n set if names of length n match
+        uint8_t events;
+    };
+
+    // Trie in breadth first order. A node's children are contiguous and sorted by label
+    struct trie
+    {
+        std::vector<uint8_t> labels;
+        std::vector<uint32_t> first_child;
+        std::vector<uint8_t> num_children;
+
+        // Watchlists ending at the node: [begin[i], begin[i + 1]) in entries, sorted by descending max_price.
+        // Forward trie nodes have two groups each (prefix patterns, then exact patterns)
+        std::vector<uint32_t> begin;
+        std::vector<entry> entries;
+
+        uint32_t child(uint32_t node, uint8_t label) const;
+    };
+
+    // Build a trie from (pattern key, group, entry) tuples
+    struct pattern_key;
+    static trie build(std::vector<pattern_key> &keys, unsigned groups);
+
+    // Append the matching entries of a group
+    static void match_group(const trie &t, uint32_t group, const event &e, unsigned length, std::vector<uint32_t> &matches);
+
+    trie forward;
+    trie reverse;
+};
+
+// Does a single watchlist match the event? (reference for the matcher)
+bool matches(const watchlist &w, const event &e);
+
+// Parse a watchlist line: <id> <pattern> [len=min-max] [max=price] [on=sell,update,proposebid].
+// Throws std::invalid_argument on failure
+watchlist parse_watchlist(std::string_view line, unsigned precision, std::string &id);
+
+// Parse an event line: <sell|update|proposebid> <account> <price>. Throws std::invalid_argument on failure
+event parse_event(std::string_view line, unsigned precision);
+
+} // namespace watch
+} // namespace nameswaps
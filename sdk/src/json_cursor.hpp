@@ -0,0 +1,294 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include "nameswaps_sdk.hpp"
+
+#include <cctype>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+// Internal to the SDK: JSON reading shared by the snapshot converter and the screening engine
+namespace nameswaps
+{
+
+// Minimal JSON cursor for node API responses (get_table_rows, get_account, ...)
+class json_cursor
+{
+
+public:
+    explicit json_cursor(std::string_view text) : text(text) {}
+
+    bool at_end()
+    {
+        skip_ws();
+        return pos >= text.size();
+    }
+
+    char peek()
+    {
+        skip_ws();
+        return pos < text.size() ? text[pos] : '\0';
+    }
+
+    void expect(char c)
+    {
+        if (peek() != c)
+        {
+            fail(std::string("expected '") + c + "'");
+        }
+        ++pos;
+    }
+
+    // Consume c if it is next
+    bool accept(char c)
+    {
+        if (peek() == c)
+        {
+            ++pos;
+            return true;
+        }
+        return false;
+    }
+
+    std::string string()
+    {
+        expect('"');
+
+        std::string out;
+        while (pos < text.size() && text[pos] != '"')
+        {
+            char c = text[pos++];
+            if (c != '\\')
+            {
+                out += c;
+                continue;
+            }
+
+            if (pos >= text.size())
+            {
+                break;
+            }
+
+            c = text[pos++];
+            switch (c)
+            {
+            case 'n':
+                out += '\n';
+                break;
+            case 't':
+                out += '\t';
+                break;
+            case 'r':
+                out += '\r';
+                break;
+            case 'b':
+                out += '\b';
+                break;
+            case 'f':
+                out += '\f';
+                break;
+            case 'u':
+                append_utf8(out, hex4());
+                break;
+            default:
+                out += c;
+                break;
+            }
+        }
+
+        expect_raw('"');
+        return out;
+    }
+
+    // Number or true/false/null token
+    std::string_view token()
+    {
+        skip_ws();
+        const size_t start = pos;
+        while (pos < text.size() && (isalnum(static_cast<unsigned char>(text[pos])) || text[pos] == '-' || text[pos] == '+' || text[pos] == '.'))
+        {
+            ++pos;
+        }
+        if (start == pos)
+        {
+            fail("expected a value");
+        }
+        return text.substr(start, pos - start);
+    }
+
+    void skip_value()
+    {
+        const char c = peek();
+        if (c == '"')
+        {
+            string();
+        }
+        else if (c == '{')
+        {
+            object([&](const std::string &) { skip_value(); });
+        }
+        else if (c == '[')
+        {
+            array([&] { skip_value(); });
+        }
+        else
+        {
+            token();
+        }
+    }
+
+    template <typename Fn>
+    void object(Fn fn)
+    {
+        expect('{');
+        if (accept('}'))
+        {
+            return;
+        }
+        do
+        {
+            const std::string key = string();
+            expect(':');
+            fn(key);
+        } while (accept(','));
+        expect('}');
+    }
+
+    template <typename Fn>
+    void array(Fn fn)
+    {
+        expect('[');
+        if (accept(']'))
+        {
+            return;
+        }
+        do
+        {
+            fn();
+        } while (accept(','));
+        expect(']');
+    }
+
+    [[noreturn]] void fail(const std::string &what)
+    {
+        throw std::runtime_error("JSON Error: " + what + " at byte " + std::to_string(pos) + ".");
+    }
+
+private:
+    void skip_ws()
+    {
+        while (pos < text.size() && isspace(static_cast<unsigned char>(text[pos])))
+        {
+            ++pos;
+        }
+    }
+
+    void expect_raw(char c)
+    {
+        if (pos >= text.size() || text[pos] != c)
+        {
+            fail(std::string("expected '") + c + "'");
+        }
+        ++pos;
+    }
+
+    uint32_t hex4()
+    {
+        if (pos + 4 > text.size())
+        {
+            fail("truncated \\u escape");
+        }
+        uint32_t value = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            const char c = text[pos++];
+            value <<= 4;
+            if (c >= '0' && c <= '9')
+                value |= c - '0';
+            else if (c >= 'a' && c <= 'f')
+                value |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F')
+                value |= c - 'A' + 10;
+            else
+                fail("bad \\u escape");
+        }
+        return value;
+    }
+
+    void append_utf8(std::string &out, uint32_t cp)
+    {
+        // Surrogate pair
+        if (cp >= 0xD800 && cp <= 0xDBFF && pos + 6 <= text.size() && text[pos] == '\\' && text[pos + 1] == 'u')
+        {
+            pos += 2;
+            const uint32_t low = hex4();
+            cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+        }
+
+        if (cp < 0x80)
+        {
+            out += char(cp);
+        }
+        else if (cp < 0x800)
+        {
+            out += char(0xC0 | (cp >> 6));
+            out += char(0x80 | (cp & 0x3F));
+        }
+        else if (cp < 0x10000)
+        {
+            out += char(0xE0 | (cp >> 12));
+            out += char(0x80 | ((cp >> 6) & 0x3F));
+            out += char(0x80 | (cp & 0x3F));
+        }
+        else
+        {
+            out += char(0xF0 | (cp >> 18));
+            out += char(0x80 | ((cp >> 12) & 0x3F));
+            out += char(0x80 | ((cp >> 6) & 0x3F));
+            out += char(0x80 | (cp & 0x3F));
+        }
+    }
+
+    std::string_view text;
+    size_t pos = 0;
+};
+
+// Field decoders
+
+inline uint64_t json_name(json_cursor &json)
+{
+    uint64_t value = 0;
+    const std::string str = json.string();
+    if (!sdk::string_to_name(str, value))
+    {
+        json.fail("invalid name \"" + str + "\"");
+    }
+    return value;
+}
+
+// Integers may be numbers or (above 32 bits) strings
+inline uint64_t json_uint(json_cursor &json)
+{
+    const std::string str = json.peek() == '"' ? json.string() : std::string(json.token());
+    if (str.empty() || str.find_first_not_of("0123456789") != std::string::npos)
+    {
+        json.fail("invalid integer \"" + str + "\"");
+    }
+    return std::stoull(str);
+}
+
+inline bool json_bool(json_cursor &json)
+{
+    const std::string_view tok = json.token();
+    if (tok == "true" || tok == "1")
+        return true;
+    if (tok == "false" || tok == "0")
+        return false;
+    json.fail("invalid bool");
+}
+
+} // namespace nameswaps
@@ -0,0 +1,482 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+
+#include "nameswaps_screen.hpp"
+#include "json_cursor.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+
+namespace nameswaps
+{
+namespace screen
+{
+
+static uint64_t name_value(std::string_view str)
+{
+    uint64_t value = 0;
+    sdk::string_to_name(str, value);
+    return value;
+}
+
+static const uint64_t OWNER = name_value("owner");
+static const uint64_t ACTIVE = name_value("active");
+
+std::string reason_names(uint32_t reasons)
+{
+
+    static const char *const names[] = {"no_state", "extra_permission", "owner_changed", "active_changed", "linked_actions", "deferred", "low_ram"};
+
+    std::string out;
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i)
+    {
+        if (reasons & (1u << i))
+        {
+            out += (out.empty() ? "" : ",");
+            out += names[i];
+        }
+    }
+
+    return out;
+}
+
+// Is the permission held by contract@perm alone, as account_auth() leaves it?
+static bool held_by_contract(const permission &perm, uint64_t contract, uint64_t contract_perm)
+{
+    return perm.threshold >= 1 &&
+           perm.num_keys == 0 &&
+           perm.num_waits == 0 &&
+           perm.accounts.size() == 1 &&
+           perm.accounts[0].actor == contract &&
+           perm.accounts[0].permission == contract_perm &&
+           perm.accounts[0].weight >= perm.threshold;
+}
+
+uint32_t screen_account(const rules &rules, const account_state *state, const std::vector<uint64_t> &deferred_accounts)
+{
+
+    if (state == nullptr)
+    {
+        return no_state;
+    }
+
+    uint32_t reasons = 0;
+
+    // ----------------------------------------------
+    // Permission checks
+    // ----------------------------------------------
+
+    bool owner_ok = false;
+    bool active_ok = false;
+    for (const auto &perm : state->permissions)
+    {
+        if (perm.num_links > 0)
+        {
+            reasons |= linked_actions;
+        }
+
+        if (perm.perm_name == OWNER)
+        {
+            owner_ok = perm.parent == 0 && held_by_contract(perm, rules.contract, OWNER);
+        }
+        else if (perm.perm_name == ACTIVE)
+        {
+            active_ok = perm.parent == OWNER && held_by_contract(perm, rules.contract, ACTIVE);
+        }
+        else
+        {
+            reasons |= extra_permission;
+        }
+    }
+
+    if (!owner_ok)
+    {
+        reasons |= owner_changed;
+    }
+    if (!active_ok)
+    {
+        reasons |= active_changed;
+    }
+
+    // ----------------------------------------------
+    // Deferred transaction and resource checks
+    // ----------------------------------------------
+
+    if (std::binary_search(deferred_accounts.begin(), deferred_accounts.end(), state->account))
+    {
+        reasons |= deferred;
+    }
+
+    if (state->ram_quota >= 0 && state->ram_quota - state->ram_usage < rules.min_free_ram)
+    {
+        reasons |= low_ram;
+    }
+
+    return reasons;
+}
+
+std::vector<decision> screen_listings(sdk::thread_pool &pool,
+                                      const rules &rules,
+                                      std::vector<listing> listings,
+                                      const std::vector<account_state> &states,
+                                      const std::vector<uint64_t> &deferred_accounts)
+{
+
+    // Account order, so the batches do not depend on the dump order or the number of threads
+    std::sort(listings.begin(), listings.end(), [](const listing &a, const listing &b) { return a.account4sale < b.account4sale; });
+    listings.erase(std::unique(listings.begin(), listings.end(), [](const listing &a, const listing &b) { return a.account4sale == b.account4sale; }),
+                   listings.end());
+
+    std::vector<decision> decisions(listings.size());
+
+    pool.parallel_for(listings.size(), 1024, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            const uint64_t account = listings[i].account4sale;
+
+            auto itr_states = std::lower_bound(states.begin(), states.end(), account,
+                                               [](const account_state &s, uint64_t a) { return s.account < a; });
+            const account_state *state = (itr_states != states.end() && itr_states->account == account) ? &*itr_states : nullptr;
+
+            decision &d = decisions[i];
+            d.account4sale = account;
+            d.reasons = screen_account(rules, state, deferred_accounts);
+            d.option = d.reasons == 0 ? 1 : 0;
+            d.changed = (d.option != 0) != listings[i].screened;
+        }
+    });
+
+    return decisions;
+}
+
+// ----------------------------------------------
+// get_account JSON
+// ----------------------------------------------
+
+// Signed integer (ram_quota is -1 for unlimited)
+static int64_t json_int(json_cursor &json)
+{
+    const std::string str = json.peek() == '"' ? json.string() : std::string(json.token());
+    const bool negative = !str.empty() && str[0] == '-';
+    if (str.size() == size_t(negative) || str.find_first_not_of("0123456789", negative ? 1 : 0) != std::string::npos)
+    {
+        json.fail("invalid integer \"" + str + "\"");
+    }
+    return std::stoll(str);
+}
+
+// Count the elements of an array without decoding them
+static uint32_t json_count(json_cursor &json)
+{
+    uint32_t count = 0;
+    if (json.peek() == '[')
+    {
+        json.array([&] {
+            json.skip_value();
+            ++count;
+        });
+    }
+    else
+    {
+        json.skip_value();
+    }
+    return count;
+}
+
+static permission json_permission(json_cursor &json)
+{
+
+    permission perm{};
+    json.object([&](const std::string &key) {
+        if (key == "perm_name")
+            perm.perm_name = json_name(json);
+        else if (key == "parent")
+            perm.parent = json_name(json);
+        else if (key == "linked_actions")
+            perm.num_links = json_count(json);
+        else if (key == "required_auth")
+        {
+            json.object([&](const std::string &auth_key) {
+                if (auth_key == "threshold")
+                    perm.threshold = static_cast<uint32_t>(json_uint(json));
+                else if (auth_key == "keys")
+                    perm.num_keys = json_count(json);
+                else if (auth_key == "waits")
+                    perm.num_waits = json_count(json);
+                else if (auth_key == "accounts")
+                {
+                    json.array([&] {
+                        permission::account_weight account{};
+                        json.object([&](const std::string &account_key) {
+                            if (account_key == "weight")
+                                account.weight = static_cast<uint16_t>(json_uint(json));
+                            else if (account_key == "permission")
+                            {
+                                json.object([&](const std::string &level_key) {
+                                    if (level_key == "actor")
+                                        account.actor = json_name(json);
+                                    else if (level_key == "permission")
+                                        account.permission = json_name(json);
+                                    else
+                                        json.skip_value();
+                                });
+                            }
+                            else
+                                json.skip_value();
+                        });
+                        perm.accounts.push_back(account);
+                    });
+                }
+                else
+                    json.skip_value();
+            });
+        }
+        else
+            json.skip_value();
+    });
+
+    return perm;
+}
+
+static account_state json_account_state(json_cursor &json)
+{
+
+    account_state state{};
+    bool named = false;
+    json.object([&](const std::string &key) {
+        if (key == "account_name")
+        {
+            state.account = json_name(json);
+            named = true;
+        }
+        else if (key == "ram_quota")
+            state.ram_quota = json_int(json);
+        else if (key == "ram_usage")
+            state.ram_usage = json_int(json);
+        else if (key == "permissions")
+            json.array([&] { state.permissions.push_back(json_permission(json)); });
+        else
+            json.skip_value();
+    });
+
+    if (!named)
+    {
+        json.fail("get_account response without account_name");
+    }
+
+    return state;
+}
+
+// Spans of the top level objects: the elements of a JSON array, or objects one after another
+static std::vector<std::string_view> object_spans(std::string_view text)
+{
+
+    std::vector<std::string_view> spans;
+
+    size_t depth = 0;
+    size_t start = 0;
+    bool in_string = false;
+    for (size_t pos = 0; pos < text.size(); ++pos)
+    {
+        const char c = text[pos];
+        if (in_string)
+        {
+            if (c == '\\')
+                ++pos;
+            else if (c == '"')
+                in_string = false;
+        }
+        else if (c == '"')
+        {
+            if (depth == 0)
+                throw std::runtime_error("JSON Error: expected an object at byte " + std::to_string(pos) + ".");
+            in_string = true;
+        }
+        else if (c == '{')
+        {
+            if (depth++ == 0)
+                start = pos;
+        }
+        else if (c == '}')
+        {
+            if (depth == 0)
+                throw std::runtime_error("JSON Error: unexpected '}' at byte " + std::to_string(pos) + ".");
+            if (--depth == 0)
+                spans.push_back(text.substr(start, pos + 1 - start));
+        }
+        else if (depth == 0 && !isspace(static_cast<unsigned char>(c)) && c != '[' && c != ']' && c != ',')
+        {
+            throw std::runtime_error("JSON Error: expected an object at byte " + std::to_string(pos) + ".");
+        }
+    }
+
+    if (depth != 0 || in_string)
+    {
+        throw std::runtime_error("JSON Error: unterminated object at byte " + std::to_string(start) + ".");
+    }
+
+    return spans;
+}
+
+std::vector<account_state> account_states_from_json(sdk::thread_pool &pool, std::string_view text)
+{
+
+    // Splitting is a cheap serial scan. Decoding the objects is the work that is spread across the pool
+    const std::vector<std::string_view> spans = object_spans(text);
+    std::vector<account_state> states(spans.size());
+
+    // Report the first failing object whatever the thread timing
+    std::mutex error_lock;
+    size_t error_index = spans.size();
+    std::string error;
+
+    pool.parallel_for(spans.size(), 64, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            try
+            {
+                json_cursor json(spans[i]);
+                states[i] = json_account_state(json);
+            }
+            catch (const std::exception &e)
+            {
+                std::lock_guard<std::mutex> guard(error_lock);
+                if (i < error_index)
+                {
+                    error_index = i;
+                    error = e.what();
+                }
+            }
+        }
+    });
+
+    if (error_index < spans.size())
+    {
+        throw std::runtime_error("get_account response " + std::to_string(error_index) + ": " + error);
+    }
+
+    std::sort(states.begin(), states.end(), [](const account_state &a, const account_state &b) { return a.account < b.account; });
+    return states;
+}
+
+// ----------------------------------------------
+// get_scheduled_transactions JSON
+// ----------------------------------------------
+
+// Actors in the authorizations of an action array
+static void json_actors(json_cursor &json, std::vector<uint64_t> &accounts)
+{
+    json.array([&] {
+        json.object([&](const std::string &key) {
+            if (key == "authorization")
+            {
+                json.array([&] {
+                    json.object([&](const std::string &level_key) {
+                        if (level_key == "actor")
+                            accounts.push_back(json_name(json));
+                        else
+                            json.skip_value();
+                    });
+                });
+            }
+            else
+                json.skip_value();
+        });
+    });
+}
+
+std::vector<uint64_t> deferred_accounts_from_json(std::string_view text)
+{
+
+    std::vector<uint64_t> accounts;
+
+    json_cursor json(text);
+    while (!json.at_end())
+    {
+        json.object([&](const std::string &key) {
+            if (key != "transactions")
+            {
+                json.skip_value();
+                return;
+            }
+
+            json.array([&] {
+                json.object([&](const std::string &trx_key) {
+                    if (trx_key == "sender" || trx_key == "payer")
+                        accounts.push_back(json_name(json));
+                    else if (trx_key == "transaction" && json.peek() == '{')
+                    {
+                        // Decoded transaction (json=true). A packed hex transaction only gives sender and payer
+                        json.object([&](const std::string &body_key) {
+                            if (body_key == "actions" || body_key == "context_free_actions")
+                                json_actors(json, accounts);
+                            else
+                                json.skip_value();
+                        });
+                    }
+                    else
+                        json.skip_value();
+                });
+            });
+        });
+
+        // Concatenated pages may be separated by commas
+        json.accept(',');
+    }
+
+    std::sort(accounts.begin(), accounts.end());
+    accounts.erase(std::unique(accounts.begin(), accounts.end()), accounts.end());
+    return accounts;
+}
+
+// ----------------------------------------------
+// screenbatch output
+// ----------------------------------------------
+
+std::string screenbatch_actions(uint64_t contract, const std::vector<decision> &decisions, size_t batch_size, bool all)
+{
+
+    const std::string contract_name = sdk::name_to_string(contract);
+    batch_size = std::max(batch_size, size_t(1));
+
+    std::string out;
+    size_t in_batch = 0;
+    for (const auto &d : decisions)
+    {
+        if (!all && !d.changed)
+        {
+            continue;
+        }
+
+        if (in_batch == 0)
+        {
+            out += "{\"actions\":[{\"account\":\"" + contract_name + "\",\"name\":\"screenbatch\",\"authorization\":[{\"actor\":\"" +
+                   contract_name + "\",\"permission\":\"active\"}],\"data\":{\"screenings\":[";
+        }
+        else
+        {
+            out += ",";
+        }
+
+        out += "{\"account4sale\":\"" + sdk::name_to_string(d.account4sale) + "\",\"option\":" + std::to_string(d.option) + "}";
+
+        if (++in_batch == batch_size)
+        {
+            out += "]}}]}\n";
+            in_batch = 0;
+        }
+    }
+
+    if (in_batch > 0)
+    {
+        out += "]}}]}\n";
+    }
+
+    return out;
+}
+
+} // namespace screen
+} // namespace nameswaps
@@ -0,0 +1,370 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+
+#include "nameswaps_sdk.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace eosio
+{
+
+// The contract aborts the transaction on a failed check. The host throws instead
+inline void check(bool pred, const char *msg)
+{
+    if (!pred)
+    {
+        throw std::invalid_argument(msg);
+    }
+}
+
+} // namespace eosio
+
+// Same key decoding and memo grammar as the contract
+#include "abieos_numeric.hpp"
+#include "buy_memo.hpp"
+
+namespace nameswaps
+{
+namespace sdk
+{
+
+// Value of a name character, or -1 if it is not allowed (eosio::name::char_to_value)
+static int name_char_value(char c)
+{
+    if (c == '.')
+        return 0;
+    else if (c >= '1' && c <= '5')
+        return (c - '1') + 1;
+    else if (c >= 'a' && c <= 'z')
+        return (c - 'a') + 6;
+
+    return -1;
+}
+
+// Encode a name. Returns the eosio::name error message, or nullptr if the name is valid
+static const char *encode_name(std::string_view str, uint64_t &value)
+{
+
+    value = 0;
+
+    if (str.size() > 13)
+    {
+        return "string is too long to be a valid name";
+    }
+
+    const size_t n = std::min(str.size(), size_t(12));
+    for (size_t i = 0; i < n; ++i)
+    {
+        const int v = name_char_value(str[i]);
+        if (v < 0)
+        {
+            return "character is not in allowed character set for names";
+        }
+
+        value |= uint64_t(v) << (64 - 5 * (i + 1));
+    }
+
+    if (str.size() == 13)
+    {
+        const int v = name_char_value(str[12]);
+        if (v < 0)
+        {
+            return "character is not in allowed character set for names";
+        }
+        if (v > 0x0F)
+        {
+            return "thirteenth character in name cannot be a letter that comes after j";
+        }
+
+        value |= uint64_t(v);
+    }
+
+    return nullptr;
+}
+
+// Decode a public key. Returns the abieos error message, or an empty string if the key decodes
+static std::string decode_key(std::string_view key)
+{
+    try
+    {
+        abieos::string_to_public_key(key);
+    }
+    catch (const std::invalid_argument &e)
+    {
+        return e.what();
+    }
+
+    return std::string();
+}
+
+bool string_to_name(std::string_view str, uint64_t &value)
+{
+    return encode_name(str, value) == nullptr;
+}
+
+std::string name_to_string(uint64_t value)
+{
+
+    static const char charmap[] = ".12345abcdefghijklmnopqrstuvwxyz";
+
+    std::string str(13, '.');
+    uint64_t tmp = value;
+    for (int i = 0; i <= 12; ++i)
+    {
+        const char c = charmap[tmp & (i == 0 ? 0x0f : 0x1f)];
+        str[12 - i] = c;
+        tmp >>= (i == 0 ? 4 : 5);
+    }
+
+    // Trailing dots are not part of the name
+    str.erase(str.find_last_not_of('.') + 1);
+    return str;
+}
+
+bool valid_public_key(std::string_view key)
+{
+    return decode_key(key).empty();
+}
+
+std::string make_memo(std::string_view code, std::string_view account_name, std::string_view owner_key, std::string_view active_key, std::string_view referrer)
+{
+
+    std::string memo;
+    memo.reserve(code.size() + account_name.size() + 2 * KEY_LENGTH + referrer.size() + 3);
+
+    memo.append(code).append(account_name);
+    memo.append(",").append(owner_key);
+    memo.append(",").append(active_key);
+    if (!referrer.empty())
+    {
+        memo.append(",").append(referrer);
+    }
+
+    return memo;
+}
+
+intent_result check_intent(const purchase_intent &intent)
+{
+
+    intent_result result{false, std::string(), 0, 0};
+
+    // ----------------------------------------------
+    // Memo checks
+    // ----------------------------------------------
+
+    const std::string_view code = buy_code(intent.memo);
+    if (!valid_buy_code(code))
+    {
+        result.error = "Buy Error: Malformed buy string.";
+        return result;
+    }
+
+    if (intent.quantity <= 0)
+    {
+        result.error = "must transfer positive quantity";
+        return result;
+    }
+
+    buy_memo parsed;
+    if (const char *error = parse_buy_memo(intent.memo, parsed))
+    {
+        result.error = (code == "wt:" || code == "bk:" || code == "cr:" || code == "rl:") ? "SDK Error: Only cn:, sp: and mk: memos can be checked." : error;
+        return result;
+    }
+
+    if (const char *error = encode_name(parsed.account_name, result.account))
+    {
+        result.error = error;
+        return result;
+    }
+
+    // The contract decodes both keys before changing the account's permissions
+    result.error = decode_key(parsed.owner_key);
+    if (result.error.empty())
+    {
+        result.error = decode_key(parsed.active_key);
+    }
+    if (!result.error.empty())
+    {
+        return result;
+    }
+
+    uint64_t referrer = 0;
+    if (const char *error = encode_name(parsed.referrer, referrer))
+    {
+        result.error = error;
+        return result;
+    }
+
+    // ----------------------------------------------
+    // Price checks
+    // ----------------------------------------------
+
+    // Trailing dots are not part of the name (eosio::name::length)
+    std::string_view account_name = parsed.account_name;
+    while (!account_name.empty() && account_name.back() == '.')
+    {
+        account_name.remove_suffix(1);
+    }
+
+    if (code == "cn:")
+    {
+        const std::string_view suffix = account_name.size() >= 2 ? account_name.substr(account_name.size() - 2) : std::string_view();
+        if (!valid_custom_suffix(suffix))
+        {
+            result.error = "Custom Error: That is not a valid suffix.";
+            return result;
+        }
+
+        result.price = custom_price(suffix, static_cast<int>(account_name.size()));
+        if (result.price == 0)
+        {
+            result.error = "Custom Error: Incorrect custom name length";
+            return result;
+        }
+
+        if (intent.quantity != result.price)
+        {
+            result.error = "Custom Error: Wrong amount transferred.";
+            return result;
+        }
+    }
+    else if (code == "sp:")
+    {
+        result.price = intent.price;
+        if (intent.price != 0 && intent.quantity != intent.price)
+        {
+            result.error = "Buy Error: You have not transferred the correct amount. Check the sale price.";
+            return result;
+        }
+    }
+    else if (code == "mk:")
+    {
+        // The system contract only lets the suffix owner create names with dots or fewer than 12 characters
+        if (account_name.size() != 12 || account_name.find('.') != std::string_view::npos)
+        {
+            result.error = "Make Error: New accounts must be 12 characters without dots.";
+            return result;
+        }
+
+        result.price = intent.price;
+        if (intent.quantity < intent.price)
+        {
+            result.error = "Custom Error: Wrong amount transferred.";
+            return result;
+        }
+    }
+
+    result.ok = true;
+    return result;
+}
+
+thread_pool::thread_pool(unsigned threads)
+{
+
+    if (threads == 0)
+    {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (unsigned i = 0; i < threads; ++i)
+    {
+        workers.emplace_back([this] { run(); });
+    }
+}
+
+thread_pool::~thread_pool()
+{
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+void thread_pool::parallel_for(size_t count, size_t grain, const std::function<void(size_t, size_t)> &fn)
+{
+
+    if (count == 0)
+    {
+        return;
+    }
+
+    grain = std::max(grain, size_t(1));
+
+    std::unique_lock<std::mutex> guard(lock);
+    job = &fn;
+    job_count = count;
+    job_grain = grain;
+    next_chunk = 0;
+    chunks_left = (count + grain - 1) / grain;
+    generation++;
+    wake.notify_all();
+
+    // Wait until every chunk has run
+    done.wait(guard, [this] { return chunks_left == 0; });
+    job = nullptr;
+}
+
+void thread_pool::run()
+{
+
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> guard(lock);
+
+    while (true)
+    {
+        wake.wait(guard, [&] { return stopping || (job != nullptr && generation != seen); });
+        if (stopping)
+        {
+            return;
+        }
+
+        // Take chunks until the job is exhausted
+        const size_t total_chunks = (job_count + job_grain - 1) / job_grain;
+        while (job != nullptr && next_chunk < total_chunks)
+        {
+            const size_t begin = next_chunk++ * job_grain;
+            const size_t end = std::min(begin + job_grain, job_count);
+            const auto *fn = job;
+
+            guard.unlock();
+            (*fn)(begin, end);
+            guard.lock();
+
+            if (--chunks_left == 0)
+            {
+                done.notify_all();
+            }
+        }
+
+        seen = generation;
+    }
+}
+
+std::vector<intent_result> check_intents(thread_pool &pool, const std::vector<purchase_intent> &intents)
+{
+
+    std::vector<intent_result> results(intents.size());
+
+    pool.parallel_for(intents.size(), 256, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            results[i] = check_intent(intents[i]);
+        }
+    });
+
+    return results;
+}
+
+} // namespace sdk
+} // namespace nameswaps
@@ -0,0 +1,569 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+
+#include "nameswaps_snapshot.hpp"
+#include "nameswaps_sdk.hpp"
+#include "json_cursor.hpp"
+#include "buy_memo.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace nameswaps
+{
+namespace snapshot
+{
+
+// ----------------------------------------------
+// File layout
+// ----------------------------------------------
+
+static const char MAGIC[8] = {'N', 'S', 'W', 'P', 'S', 'N', 'A', 'P'};
+
+struct file_header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t num_tables;
+};
+
+struct table_entry
+{
+    uint64_t table;
+    uint64_t rows;
+    uint32_t num_columns;
+    uint32_t reserved;
+    uint64_t columns_offset;
+};
+
+struct column_entry
+{
+    uint32_t type;
+    uint32_t reserved;
+    uint64_t offset;
+    uint64_t size;
+};
+
+static_assert(sizeof(file_header) == 16, "Snapshot header must be 16 bytes");
+static_assert(sizeof(table_entry) == 32, "Snapshot table entry must be 32 bytes");
+static_assert(sizeof(column_entry) == 24, "Snapshot column entry must be 24 bytes");
+
+// Table names
+static uint64_t table_name(std::string_view str)
+{
+    uint64_t value = 0;
+    sdk::string_to_name(str, value);
+    return value;
+}
+
+static const uint64_t ACCOUNTS = table_name("accounts");
+static const uint64_t EXTRAS = table_name("extras");
+static const uint64_t BIDS = table_name("bids");
+static const uint64_t STATS = table_name("stats");
+
+static size_t align8(size_t n)
+{
+    return (n + 7) & ~size_t(7);
+}
+
+size_t find_key(const column_view<uint64_t> &keys, uint64_t key)
+{
+    const uint64_t *itr = std::lower_bound(keys.begin(), keys.end(), key);
+    return (itr != keys.end() && *itr == key) ? size_t(itr - keys.begin()) : npos;
+}
+
+// ----------------------------------------------
+// Writer
+// ----------------------------------------------
+
+struct column_data
+{
+    column_type type;
+    std::vector<uint8_t> bytes;
+};
+
+struct table_data
+{
+    uint64_t table;
+    uint64_t rows;
+    std::vector<column_data> columns;
+};
+
+// Fixed width column from a row field
+template <typename T, typename Row, typename Get>
+static column_data fixed_column(column_type type, const std::vector<Row> &rows, Get get)
+{
+    column_data column{type, std::vector<uint8_t>(rows.size() * sizeof(T))};
+    T *data = reinterpret_cast<T *>(column.bytes.data());
+    for (size_t i = 0; i < rows.size(); ++i)
+    {
+        data[i] = get(rows[i]);
+    }
+    return column;
+}
+
+// String column from a row field (offsets, then the blob)
+template <typename Row, typename Get>
+static column_data string_column(const std::vector<Row> &rows, Get get)
+{
+    std::vector<uint32_t> offsets(rows.size() + 1, 0);
+    std::string blob;
+    for (size_t i = 0; i < rows.size(); ++i)
+    {
+        blob += get(rows[i]);
+        if (blob.size() > UINT32_MAX)
+        {
+            throw std::runtime_error("Snapshot Error: String column is larger than 4 GB.");
+        }
+        offsets[i + 1] = static_cast<uint32_t>(blob.size());
+    }
+
+    column_data column{column_type::string, std::vector<uint8_t>(offsets.size() * sizeof(uint32_t) + blob.size())};
+    memcpy(column.bytes.data(), offsets.data(), offsets.size() * sizeof(uint32_t));
+    memcpy(column.bytes.data() + offsets.size() * sizeof(uint32_t), blob.data(), blob.size());
+    return column;
+}
+
+template <typename Row, typename Key>
+static void sort_rows(std::vector<Row> &rows, Key key)
+{
+    std::sort(rows.begin(), rows.end(), [&](const Row &a, const Row &b) { return key(a) < key(b); });
+}
+
+void write_snapshot(const std::string &path,
+                    std::vector<account_row> accounts,
+                    std::vector<extras_row> extras,
+                    std::vector<bids_row> bids,
+                    std::vector<stats_row> stats)
+{
+
+    sort_rows(accounts, [](const account_row &r) { return r.account4sale; });
+    sort_rows(extras, [](const extras_row &r) { return r.account4sale; });
+    sort_rows(bids, [](const bids_row &r) { return r.account4sale; });
+    sort_rows(stats, [](const stats_row &r) { return r.index; });
+
+    std::vector<table_data> tables;
+
+    tables.push_back({ACCOUNTS, accounts.size(), {}});
+    tables.back().columns.push_back(fixed_column<uint64_t>(column_type::u64, accounts, [](const account_row &r) { return r.account4sale; }));
+    tables.back().columns.push_back(fixed_column<int64_t>(column_type::i64, accounts, [](const account_row &r) { return r.saleprice.amount; }));
+    tables.back().columns.push_back(fixed_column<uint64_t>(column_type::u64, accounts, [](const account_row &r) { return r.saleprice.symbol; }));
+    tables.back().columns.push_back(fixed_column<uint64_t>(column_type::u64, accounts, [](const account_row &r) { return r.paymentaccnt; }));
+
+    tables.push_back({EXTRAS, extras.size(), {}});
+    tables.back().columns.push_back(fixed_column<uint64_t>(column_type::u64, extras, [](const extras_row &r) { return r.account4sale; }));
+    tables.back().columns.push_back(fixed_column<uint8_t>(column_type::u8, extras, [](const extras_row &r) { return uint8_t(r.screened); }));
+    tables.back().columns.push_back(fixed_column<uint64_t>(column_type::u64, extras, [](const extras_row &r) { return r.numberofvotes; }));
+    tables.back().columns.push_back(fixed_column<uint64_t>(column_type::u64, extras, [](const extras_row &r) { return r.last_voter; }));
+    tables.back().columns.push_back(string_column(extras, [](const extras_row &r) -> const std::string & { return r.message; }));
+
+    tables.push_back({BIDS, bids.size(), {}});
+    tables.back().columns.push_back(fixed_column<uint64_t>(column_type::u64, bids, [](const bids_row &r) { return r.account4sale; }));
+    tables.back().columns.push_back(fixed_column<uint16_t>(column_type::u16, bids, [](const bids_row &r) { return r.bidaccepted; }));
+    tables.back().columns.push_back(fixed_column<int64_t>(column_type::i64, bids, [](const bids_row &r) { return r.bidprice.amount; }));
+    tables.back().columns.push_back(fixed_column<uint64_t>(column_type::u64, bids, [](const bids_row &r) { return r.bidprice.symbol; }));
+    tables.back().columns.push_back(fixed_column<uint64_t>(column_type::u64, bids, [](const bids_row &r) { return r.bidder; }));
+
+    tables.push_back({STATS, stats.size(), {}});
+    tables.back().columns.push_back(fixed_column<uint64_t>(column_type::u64, stats, [](const stats_row &r) { return r.index; }));
+    tables.back().columns.push_back(fixed_column<uint64_t>(column_type::u64, stats, [](const stats_row &r) { return r.num_listed; }));
+    tables.back().columns.push_back(fixed_column<uint64_t>(column_type::u64, stats, [](const stats_row &r) { return r.num_purchased; }));
+    tables.back().columns.push_back(fixed_column<int64_t>(column_type::i64, stats, [](const stats_row &r) { return r.tot_sales.amount; }));
+    tables.back().columns.push_back(fixed_column<uint64_t>(column_type::u64, stats, [](const stats_row &r) { return r.tot_sales.symbol; }));
+    tables.back().columns.push_back(fixed_column<int64_t>(column_type::i64, stats, [](const stats_row &r) { return r.tot_fees.amount; }));
+    tables.back().columns.push_back(fixed_column<uint64_t>(column_type::u64, stats, [](const stats_row &r) { return r.tot_fees.symbol; }));
+
+    // Lay out the directory, the column entries and then the data
+    std::vector<table_entry> table_entries;
+    std::vector<column_entry> column_entries;
+
+    size_t offset = sizeof(file_header) + tables.size() * sizeof(table_entry);
+    for (const auto &table : tables)
+    {
+        table_entries.push_back({table.table, table.rows, uint32_t(table.columns.size()), 0, offset});
+        offset += table.columns.size() * sizeof(column_entry);
+    }
+
+    offset = align8(offset);
+    for (const auto &table : tables)
+    {
+        for (const auto &column : table.columns)
+        {
+            column_entries.push_back({uint32_t(column.type), 0, offset, column.bytes.size()});
+            offset = align8(offset + column.bytes.size());
+        }
+    }
+
+    // Write to a temporary file and rename, so readers never map a partial snapshot
+    const std::string tmp_path = path + ".tmp";
+    std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+    if (!out)
+    {
+        throw std::runtime_error("Snapshot Error: Cannot create " + tmp_path);
+    }
+
+    file_header header;
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = FORMAT_VERSION;
+    header.num_tables = uint32_t(tables.size());
+
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(table_entries.data()), table_entries.size() * sizeof(table_entry));
+    out.write(reinterpret_cast<const char *>(column_entries.data()), column_entries.size() * sizeof(column_entry));
+
+    static const char padding[8] = {0};
+    size_t written = sizeof(header) + table_entries.size() * sizeof(table_entry) + column_entries.size() * sizeof(column_entry);
+    size_t entry = 0;
+    for (const auto &table : tables)
+    {
+        for (const auto &column : table.columns)
+        {
+            out.write(padding, column_entries[entry].offset - written);
+            out.write(reinterpret_cast<const char *>(column.bytes.data()), column.bytes.size());
+            written = column_entries[entry].offset + column.bytes.size();
+            ++entry;
+        }
+    }
+    out.write(padding, align8(written) - written);
+
+    out.close();
+    if (!out || rename(tmp_path.c_str(), path.c_str()) != 0)
+    {
+        throw std::runtime_error("Snapshot Error: Cannot write " + path);
+    }
+}
+
+// ----------------------------------------------
+// Reader
+// ----------------------------------------------
+
+reader::reader(const std::string &path)
+{
+
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw std::runtime_error("Snapshot Error: Cannot open " + path);
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(file_header))
+    {
+        close(fd);
+        throw std::runtime_error("Snapshot Error: " + path + " is not a snapshot.");
+    }
+
+    length = size_t(st.st_size);
+    void *mapping = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        throw std::runtime_error("Snapshot Error: Cannot map " + path);
+    }
+    base = static_cast<const uint8_t *>(mapping);
+
+    const file_header *header = reinterpret_cast<const file_header *>(base);
+    if (memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->version != FORMAT_VERSION ||
+        sizeof(file_header) + uint64_t(header->num_tables) * sizeof(table_entry) > length)
+    {
+        munmap(const_cast<uint8_t *>(base), length);
+        throw std::runtime_error("Snapshot Error: " + path + " is not a version " + std::to_string(FORMAT_VERSION) + " snapshot.");
+    }
+
+    try
+    {
+        accounts_table.account4sale = column<uint64_t>(ACCOUNTS, 0, column_type::u64);
+        accounts_table.saleprice_amount = column<int64_t>(ACCOUNTS, 1, column_type::i64);
+        accounts_table.saleprice_symbol = column<uint64_t>(ACCOUNTS, 2, column_type::u64);
+        accounts_table.paymentaccnt = column<uint64_t>(ACCOUNTS, 3, column_type::u64);
+
+        extras_table.account4sale = column<uint64_t>(EXTRAS, 0, column_type::u64);
+        extras_table.screened = column<uint8_t>(EXTRAS, 1, column_type::u8);
+        extras_table.numberofvotes = column<uint64_t>(EXTRAS, 2, column_type::u64);
+        extras_table.last_voter = column<uint64_t>(EXTRAS, 3, column_type::u64);
+        extras_table.message = string_column(EXTRAS, 4);
+
+        bids_table.account4sale = column<uint64_t>(BIDS, 0, column_type::u64);
+        bids_table.bidaccepted = column<uint16_t>(BIDS, 1, column_type::u16);
+        bids_table.bidprice_amount = column<int64_t>(BIDS, 2, column_type::i64);
+        bids_table.bidprice_symbol = column<uint64_t>(BIDS, 3, column_type::u64);
+        bids_table.bidder = column<uint64_t>(BIDS, 4, column_type::u64);
+
+        stats_table.index = column<uint64_t>(STATS, 0, column_type::u64);
+        stats_table.num_listed = column<uint64_t>(STATS, 1, column_type::u64);
+        stats_table.num_purchased = column<uint64_t>(STATS, 2, column_type::u64);
+        stats_table.tot_sales_amount = column<int64_t>(STATS, 3, column_type::i64);
+        stats_table.tot_sales_symbol = column<uint64_t>(STATS, 4, column_type::u64);
+        stats_table.tot_fees_amount = column<int64_t>(STATS, 5, column_type::i64);
+        stats_table.tot_fees_symbol = column<uint64_t>(STATS, 6, column_type::u64);
+    }
+    catch (...)
+    {
+        munmap(const_cast<uint8_t *>(base), length);
+        throw;
+    }
+}
+
+reader::~reader()
+{
+    munmap(const_cast<uint8_t *>(base), length);
+}
+
+// Column entry of a table, or nullptr if the table is not in the snapshot
+static const column_entry *find_column(const uint8_t *base, size_t length, uint64_t table, uint32_t index, uint64_t &rows)
+{
+
+    const file_header *header = reinterpret_cast<const file_header *>(base);
+    const table_entry *tables = reinterpret_cast<const table_entry *>(base + sizeof(file_header));
+
+    for (uint32_t i = 0; i < header->num_tables; ++i)
+    {
+        if (tables[i].table != table)
+        {
+            continue;
+        }
+
+        if (index >= tables[i].num_columns || tables[i].columns_offset + (index + 1) * sizeof(column_entry) > length)
+        {
+            throw std::runtime_error("Snapshot Error: Column directory is truncated.");
+        }
+
+        const column_entry *column = reinterpret_cast<const column_entry *>(base + tables[i].columns_offset) + index;
+        if (column->offset % 8 != 0 || column->offset > length || column->size > length - column->offset)
+        {
+            throw std::runtime_error("Snapshot Error: Column data is out of bounds.");
+        }
+
+        rows = tables[i].rows;
+        return column;
+    }
+
+    return nullptr;
+}
+
+template <typename T>
+column_view<T> reader::column(uint64_t table, uint32_t index, column_type type) const
+{
+
+    uint64_t rows = 0;
+    const column_entry *entry = find_column(base, length, table, index, rows);
+    if (entry == nullptr)
+    {
+        return column_view<T>();
+    }
+
+    if (entry->type != uint32_t(type) || entry->size != rows * sizeof(T))
+    {
+        throw std::runtime_error("Snapshot Error: Column type or size does not match its table.");
+    }
+
+    return column_view<T>(reinterpret_cast<const T *>(base + entry->offset), rows);
+}
+
+string_column_view reader::string_column(uint64_t table, uint32_t index) const
+{
+
+    uint64_t rows = 0;
+    const column_entry *entry = find_column(base, length, table, index, rows);
+    if (entry == nullptr)
+    {
+        return string_column_view();
+    }
+
+    const uint64_t offsets_size = (rows + 1) * sizeof(uint32_t);
+    if (entry->type != uint32_t(column_type::string) || entry->size < offsets_size)
+    {
+        throw std::runtime_error("Snapshot Error: Column type or size does not match its table.");
+    }
+
+    // Offsets must be increasing and inside the blob
+    const uint32_t *offsets = reinterpret_cast<const uint32_t *>(base + entry->offset);
+    for (uint64_t i = 0; i < rows; ++i)
+    {
+        if (offsets[i] > offsets[i + 1])
+        {
+            throw std::runtime_error("Snapshot Error: String offsets are not increasing.");
+        }
+    }
+    if (offsets[0] != 0 || offsets[rows] != entry->size - offsets_size)
+    {
+        throw std::runtime_error("Snapshot Error: String offsets do not match the blob.");
+    }
+
+    return string_column_view(offsets, reinterpret_cast<const char *>(base + entry->offset + offsets_size), rows);
+}
+
+// ----------------------------------------------
+// get_table_rows JSON
+// ----------------------------------------------
+
+// Asset string, e.g. "1.00000000 WAX"
+static asset json_asset(json_cursor &json)
+{
+
+    const std::string str = json.string();
+    const size_t space = str.find(' ');
+    if (space == std::string::npos || space == 0 || str.size() - space - 1 < 1 || str.size() - space - 1 > 7)
+    {
+        json.fail("invalid asset \"" + str + "\"");
+    }
+
+    const std::string amount = str.substr(0, space);
+    const std::string code = str.substr(space + 1);
+
+    // The amount's decimals are the symbol precision. Digits are parsed like memo amounts (overflow checked)
+    const bool negative = amount[0] == '-';
+    const std::string_view digits = std::string_view(amount).substr(negative ? 1 : 0);
+    const size_t dot = digits.find('.');
+    const uint64_t precision = dot == std::string_view::npos ? 0 : digits.size() - dot - 1;
+
+    int64_t value = 0;
+    if (!memo_amount(digits, unsigned(precision), value))
+    {
+        json.fail("invalid asset \"" + str + "\"");
+    }
+
+    uint64_t symbol = precision;
+    for (size_t i = 0; i < code.size(); ++i)
+    {
+        if (code[i] < 'A' || code[i] > 'Z')
+            json.fail("invalid asset symbol \"" + str + "\"");
+        symbol |= uint64_t(uint8_t(code[i])) << (8 * (i + 1));
+    }
+
+    return {negative ? -value : value, symbol};
+}
+
+// Call row_fn for every row object in one or more responses or row arrays
+template <typename Fn>
+static void json_rows(std::string_view text, Fn row_fn)
+{
+
+    json_cursor json(text);
+    while (!json.at_end())
+    {
+        if (json.peek() == '[')
+        {
+            json.array([&] { row_fn(json); });
+        }
+        else
+        {
+            json.object([&](const std::string &key) {
+                if (key == "rows")
+                {
+                    json.array([&] { row_fn(json); });
+                }
+                else
+                {
+                    json.skip_value();
+                }
+            });
+        }
+
+        // Concatenated pages may be separated by commas
+        json.accept(',');
+    }
+}
+
+std::vector<account_row> accounts_from_json(std::string_view text)
+{
+    std::vector<account_row> rows;
+    json_rows(text, [&](json_cursor &json) {
+        account_row row{};
+        json.object([&](const std::string &key) {
+            if (key == "account4sale")
+                row.account4sale = json_name(json);
+            else if (key == "saleprice")
+                row.saleprice = json_asset(json);
+            else if (key == "paymentaccnt")
+                row.paymentaccnt = json_name(json);
+            else
+                json.skip_value();
+        });
+        rows.push_back(row);
+    });
+    return rows;
+}
+
+std::vector<extras_row> extras_from_json(std::string_view text)
+{
+    std::vector<extras_row> rows;
+    json_rows(text, [&](json_cursor &json) {
+        extras_row row{};
+        json.object([&](const std::string &key) {
+            if (key == "account4sale")
+                row.account4sale = json_name(json);
+            else if (key == "screened")
+                row.screened = json_bool(json);
+            else if (key == "numberofvotes")
+                row.numberofvotes = json_uint(json);
+            else if (key == "last_voter")
+                row.last_voter = json_name(json);
+            else if (key == "message")
+                row.message = json.string();
+            else
+                json.skip_value();
+        });
+        rows.push_back(std::move(row));
+    });
+    return rows;
+}
+
+std::vector<bids_row> bids_from_json(std::string_view text)
+{
+    std::vector<bids_row> rows;
+    json_rows(text, [&](json_cursor &json) {
+        bids_row row{};
+        json.object([&](const std::string &key) {
+            if (key == "account4sale")
+                row.account4sale = json_name(json);
+            else if (key == "bidaccepted")
+                row.bidaccepted = static_cast<uint16_t>(json_uint(json));
+            else if (key == "bidprice")
+                row.bidprice = json_asset(json);
+            else if (key == "bidder")
+                row.bidder = json_name(json);
+            else
+                json.skip_value();
+        });
+        rows.push_back(row);
+    });
+    return rows;
+}
+
+std::vector<stats_row> stats_from_json(std::string_view text)
+{
+    std::vector<stats_row> rows;
+    json_rows(text, [&](json_cursor &json) {
+        stats_row row{};
+        json.object([&](const std::string &key) {
+            if (key == "index")
+                row.index = json_uint(json);
+            else if (key == "num_listed")
+                row.num_listed = json_uint(json);
+            else if (key == "num_purchased")
+                row.num_purchased = json_uint(json);
+            else if (key == "tot_sales")
+                row.tot_sales = json_asset(json);
+            else if (key == "tot_fees")
+                row.tot_fees = json_asset(json);
+            else
+                json.skip_value();
+        });
+        rows.push_back(row);
+    });
+    return rows;
+}
+
+} // namespace snapshot
+} // namespace nameswaps
@@ -0,0 +1,428 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+
+#include "nameswaps_watch.hpp"
+#include "nameswaps_sdk.hpp"
+
+// Prices are parsed like the amounts in transfer memos
+#include "buy_memo.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace nameswaps
+{
+namespace watch
+{
+
+// Trie label of a name character (its eosio::name value), or -1 if it is not allowed
+static int name_label(char c)
+{
+    if (c == '.')
+        return 0;
+    else if (c >= '1' && c <= '5')
+        return (c - '1') + 1;
+    else if (c >= 'a' && c <= 'z')
+        return (c - 'a') + 6;
+
+    return -1;
+}
+
+// Labels of an encoded name. Returns the name length (trailing dots are not part of the name)
+static unsigned name_labels(uint64_t account, uint8_t labels[13])
+{
+
+    unsigned length = 0;
+    for (unsigned i = 0; i < 13; ++i)
+    {
+        labels[i] = i < 12 ? uint8_t((account >> (64 - 5 * (i + 1))) & 0x1f) : uint8_t(account & 0x0f);
+        if (labels[i] != 0)
+        {
+            length = i + 1;
+        }
+    }
+
+    return length;
+}
+
+// Trie groups
+enum : unsigned
+{
+    PREFIX_GROUP = 0,
+    EXACT_GROUP = 1,
+    FORWARD_GROUPS = 2,
+    SUFFIX_GROUP = 0,
+    REVERSE_GROUPS = 1,
+};
+
+struct matcher::pattern_key
+{
+    std::string labels;
+    uint32_t group;
+    entry watch;
+};
+
+uint32_t matcher::trie::child(uint32_t node, uint8_t label) const
+{
+    const uint8_t *first = labels.data() + first_child[node];
+    const uint8_t *last = first + num_children[node];
+    const uint8_t *found = std::lower_bound(first, last, label);
+    return (found != last && *found == label) ? uint32_t(found - labels.data()) : 0;
+}
+
+matcher::trie matcher::build(std::vector<pattern_key> &keys, unsigned groups)
+{
+
+    // Prefixes sort before the keys they start, so each node's keys are a contiguous range
+    // with the keys ending at the node first
+    std::sort(keys.begin(), keys.end(), [](const pattern_key &a, const pattern_key &b) {
+        if (a.labels != b.labels)
+            return a.labels < b.labels;
+        if (a.group != b.group)
+            return a.group < b.group;
+        return a.watch.max_price > b.watch.max_price;
+    });
+
+    trie t;
+
+    // Key range and depth of each node, in breadth first order
+    std::vector<std::pair<uint32_t, uint32_t>> ranges{{0, uint32_t(keys.size())}};
+    std::vector<uint8_t> depths{0};
+    t.labels.push_back(0);
+
+    for (size_t node = 0; node < ranges.size(); ++node)
+    {
+        uint32_t lo = ranges[node].first;
+        const uint32_t hi = ranges[node].second;
+        const unsigned depth = depths[node];
+
+        // Watchlists whose pattern ends here, group by group
+        for (unsigned group = 0; group < groups; ++group)
+        {
+            t.begin.push_back(uint32_t(t.entries.size()));
+            while (lo < hi && keys[lo].labels.size() == depth && keys[lo].group == group)
+            {
+                t.entries.push_back(keys[lo++].watch);
+            }
+        }
+
+        // Children, one per distinct next label
+        t.first_child.push_back(uint32_t(ranges.size()));
+        uint8_t children = 0;
+        while (lo < hi)
+        {
+            const uint8_t label = uint8_t(keys[lo].labels[depth]);
+            uint32_t end = lo;
+            while (end < hi && uint8_t(keys[end].labels[depth]) == label)
+            {
+                ++end;
+            }
+
+            ranges.emplace_back(lo, end);
+            depths.push_back(uint8_t(depth + 1));
+            t.labels.push_back(label);
+            ++children;
+            lo = end;
+        }
+        t.num_children.push_back(children);
+    }
+
+    t.begin.push_back(uint32_t(t.entries.size()));
+
+    t.labels.shrink_to_fit();
+    t.entries.shrink_to_fit();
+    return t;
+}
+
+matcher::matcher(const std::vector<watchlist> &watchlists)
+{
+
+    std::vector<pattern_key> forward_keys;
+    std::vector<pattern_key> reverse_keys;
+
+    for (size_t i = 0; i < watchlists.size(); ++i)
+    {
+        const watchlist &w = watchlists[i];
+
+        entry watch;
+        watch.max_price = w.max_price;
+        watch.watchlist = uint32_t(i);
+        watch.lengths = 0;
+        watch.events = w.events;
+        for (unsigned length = std::max<unsigned>(w.min_length, 1); length <= std::min<unsigned>(w.max_length, 13); ++length)
+        {
+            watch.lengths |= uint16_t(1u << length);
+        }
+
+        // Classify the pattern and drop its wildcard
+        std::string_view body = w.pattern;
+        uint32_t group = EXACT_GROUP;
+        bool reversed = false;
+        if (body == "*")
+        {
+            body = std::string_view();
+            group = PREFIX_GROUP;
+        }
+        else if (!body.empty() && body.front() == '*')
+        {
+            body.remove_prefix(1);
+            group = SUFFIX_GROUP;
+            reversed = true;
+        }
+        else if (!body.empty() && body.back() == '*')
+        {
+            body.remove_suffix(1);
+            group = PREFIX_GROUP;
+        }
+
+        if ((body.empty() && w.pattern != "*") || body.size() > 13)
+        {
+            throw std::invalid_argument("Watch Error: Invalid pattern \"" + w.pattern + "\".");
+        }
+
+        pattern_key key{std::string(body.size(), '\0'), group, watch};
+        for (size_t c = 0; c < body.size(); ++c)
+        {
+            const int label = name_label(body[c]);
+            if (label < 0)
+            {
+                throw std::invalid_argument("Watch Error: Invalid pattern \"" + w.pattern + "\".");
+            }
+            key.labels[reversed ? body.size() - 1 - c : c] = char(label);
+        }
+
+        // Exact names must be names as the contract stores them
+        uint64_t value = 0;
+        if (group == EXACT_GROUP && !reversed && (!sdk::string_to_name(body, value) || body.back() == '.'))
+        {
+            throw std::invalid_argument("Watch Error: Invalid pattern \"" + w.pattern + "\".");
+        }
+
+        (reversed ? reverse_keys : forward_keys).push_back(std::move(key));
+    }
+
+    forward = build(forward_keys, FORWARD_GROUPS);
+    reverse = build(reverse_keys, REVERSE_GROUPS);
+}
+
+size_t matcher::memory_bytes() const
+{
+    size_t bytes = 0;
+    for (const trie *t : {&forward, &reverse})
+    {
+        bytes += t->labels.capacity() + t->num_children.capacity() +
+                 t->first_child.capacity() * sizeof(uint32_t) + t->begin.capacity() * sizeof(uint32_t) +
+                 t->entries.capacity() * sizeof(entry);
+    }
+    return bytes;
+}
+
+void matcher::match_group(const trie &t, uint32_t group, const event &e, unsigned length, std::vector<uint32_t> &matches)
+{
+    const uint16_t length_bit = uint16_t(1u << length);
+    for (uint32_t i = t.begin[group], end = t.begin[group + 1]; i < end; ++i)
+    {
+        const entry &watch = t.entries[i];
+
+        // Entries are sorted by ceiling, so the rest are below the price too
+        if (watch.max_price < e.price)
+        {
+            break;
+        }
+
+        if ((watch.lengths & length_bit) && (watch.events & e.kind))
+        {
+            matches.push_back(watch.watchlist);
+        }
+    }
+}
+
+void matcher::match(const event &e, std::vector<uint32_t> &matches) const
+{
+
+    uint8_t labels[13];
+    const unsigned length = name_labels(e.account, labels);
+
+    // Prefix patterns along the name, then exact patterns at its end
+    uint32_t node = 0;
+    match_group(forward, node * FORWARD_GROUPS + PREFIX_GROUP, e, length, matches);
+    unsigned depth = 0;
+    for (; depth < length; ++depth)
+    {
+        node = forward.child(node, labels[depth]);
+        if (node == 0)
+        {
+            break;
+        }
+        match_group(forward, node * FORWARD_GROUPS + PREFIX_GROUP, e, length, matches);
+    }
+    if (depth == length)
+    {
+        match_group(forward, node * FORWARD_GROUPS + EXACT_GROUP, e, length, matches);
+    }
+
+    // Suffix patterns along the reversed name
+    node = 0;
+    for (unsigned i = length; i-- > 0;)
+    {
+        node = reverse.child(node, labels[i]);
+        if (node == 0)
+        {
+            break;
+        }
+        match_group(reverse, node * REVERSE_GROUPS + SUFFIX_GROUP, e, length, matches);
+    }
+}
+
+bool matches(const watchlist &w, const event &e)
+{
+
+    const std::string account = sdk::name_to_string(e.account);
+
+    if (!(w.events & e.kind) || e.price > w.max_price || account.size() < w.min_length || account.size() > w.max_length)
+    {
+        return false;
+    }
+
+    const std::string_view pattern = w.pattern;
+    if (pattern == "*")
+    {
+        return true;
+    }
+    if (!pattern.empty() && pattern.front() == '*')
+    {
+        const std::string_view suffix = pattern.substr(1);
+        return account.size() >= suffix.size() && account.compare(account.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+    if (!pattern.empty() && pattern.back() == '*')
+    {
+        const std::string_view prefix = pattern.substr(0, pattern.size() - 1);
+        return account.compare(0, prefix.size(), prefix) == 0;
+    }
+
+    return account == pattern;
+}
+
+// Whitespace separated fields
+static std::vector<std::string_view> fields(std::string_view line)
+{
+    std::vector<std::string_view> out;
+    size_t pos = 0;
+    while (pos < line.size())
+    {
+        while (pos < line.size() && (line[pos] == ' ' || line[pos] == '\t' || line[pos] == '\r'))
+            ++pos;
+        const size_t start = pos;
+        while (pos < line.size() && line[pos] != ' ' && line[pos] != '\t' && line[pos] != '\r')
+            ++pos;
+        if (pos > start)
+            out.push_back(line.substr(start, pos - start));
+    }
+    return out;
+}
+
+static uint8_t parse_kind(std::string_view str)
+{
+    if (str == "sell")
+        return sell;
+    if (str == "update")
+        return update;
+    if (str == "proposebid")
+        return proposebid;
+    return 0;
+}
+
+watchlist parse_watchlist(std::string_view line, unsigned precision, std::string &id)
+{
+
+    const std::vector<std::string_view> f = fields(line);
+    if (f.size() < 2)
+    {
+        throw std::invalid_argument("Watch Error: Expected <id> <pattern>.");
+    }
+
+    id = std::string(f[0]);
+
+    watchlist w;
+    w.pattern = std::string(f[1]);
+
+    for (size_t i = 2; i < f.size(); ++i)
+    {
+        const std::string_view opt = f[i];
+        if (opt.substr(0, 4) == "len=")
+        {
+            const std::string range(opt.substr(4));
+            const size_t dash = range.find('-');
+            const std::string lo = range.substr(0, dash);
+            const std::string hi = dash == std::string::npos ? lo : range.substr(dash + 1);
+            if (lo.empty() || hi.empty() || lo.find_first_not_of("0123456789") != std::string::npos || hi.find_first_not_of("0123456789") != std::string::npos ||
+                lo.size() > 2 || hi.size() > 2)
+            {
+                throw std::invalid_argument("Watch Error: Invalid length range \"" + range + "\".");
+            }
+            w.min_length = uint8_t(std::stoul(lo));
+            w.max_length = uint8_t(std::stoul(hi));
+        }
+        else if (opt.substr(0, 4) == "max=")
+        {
+            if (!nameswaps::memo_amount(opt.substr(4), precision, w.max_price))
+            {
+                throw std::invalid_argument("Watch Error: Invalid price \"" + std::string(opt.substr(4)) + "\".");
+            }
+        }
+        else if (opt.substr(0, 3) == "on=")
+        {
+            std::string kinds(opt.substr(3));
+            std::replace(kinds.begin(), kinds.end(), ',', ' ');
+
+            w.events = 0;
+            for (const std::string_view kind : fields(kinds))
+            {
+                const uint8_t k = parse_kind(kind);
+                if (k == 0)
+                {
+                    throw std::invalid_argument("Watch Error: Unknown event \"" + std::string(kind) + "\".");
+                }
+                w.events |= k;
+            }
+        }
+        else
+        {
+            throw std::invalid_argument("Watch Error: Unknown option \"" + std::string(opt) + "\".");
+        }
+    }
+
+    return w;
+}
+
+event parse_event(std::string_view line, unsigned precision)
+{
+
+    const std::vector<std::string_view> f = fields(line);
+    if (f.size() < 3)
+    {
+        throw std::invalid_argument("Event Error: Expected <sell|update|proposebid> <account> <price>.");
+    }
+
+    event e;
+    e.kind = event_kind(parse_kind(f[0]));
+    if (e.kind == 0)
+    {
+        throw std::invalid_argument("Event Error: Unknown event \"" + std::string(f[0]) + "\".");
+    }
+    if (!sdk::string_to_name(f[1], e.account))
+    {
+        throw std::invalid_argument("Event Error: Invalid account \"" + std::string(f[1]) + "\".");
+    }
+    if (!nameswaps::memo_amount(f[2], precision, e.price))
+    {
+        throw std::invalid_argument("Event Error: Invalid price \"" + std::string(f[2]) + "\".");
+    }
+
+    return e;
+}
+
+} // namespace watch
+} // namespace nameswaps
@@ -0,0 +1,204 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+
+#include "nameswaps_screen.hpp"
+#include "nameswaps_sdk.hpp"
+#include "nameswaps_snapshot.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+using namespace nameswaps;
+
+static void usage(const char *program)
+{
+    fprintf(stderr,
+            "usage: %s <contract> --state accounts.json (--snapshot tables.snap | --accounts rows.json [--extras rows.json])\n"
+            "          [--deferred scheduled.json] [--min-ram bytes] [--threads N] [--batch N] [--all] [--out batches.json] [--report report.tsv]\n",
+            program);
+}
+
+static std::string read_file(const std::string &path)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+    {
+        throw std::runtime_error("Cannot open " + path);
+    }
+
+    std::ostringstream text;
+    text << in.rdbuf();
+    return text.str();
+}
+
+static void write_file(const std::string &path, const std::string &text)
+{
+    if (path.empty() || path == "-")
+    {
+        fwrite(text.data(), 1, text.size(), stdout);
+        return;
+    }
+
+    std::ofstream out(path, std::ios::binary);
+    out << text;
+    if (!out)
+    {
+        throw std::runtime_error("Cannot write " + path);
+    }
+}
+
+static double elapsed_ms(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Listings and their screening status from a snapshot
+static std::vector<screen::listing> snapshot_listings(const std::string &path)
+{
+
+    snapshot::reader snap(path);
+
+    std::vector<screen::listing> listings;
+    listings.reserve(snap.accounts().size());
+    for (const uint64_t account : snap.accounts().account4sale)
+    {
+        const size_t row = snap.extras().find(account);
+        listings.push_back({account, row != snapshot::npos && snap.extras().screened[row] != 0});
+    }
+
+    return listings;
+}
+
+// Listings and their screening status from accounts and extras dumps
+static std::vector<screen::listing> json_listings(const std::string &accounts_path, const std::string &extras_path)
+{
+
+    std::vector<snapshot::extras_row> extras;
+    if (!extras_path.empty())
+    {
+        extras = snapshot::extras_from_json(read_file(extras_path));
+        std::sort(extras.begin(), extras.end(), [](const snapshot::extras_row &a, const snapshot::extras_row &b) { return a.account4sale < b.account4sale; });
+    }
+
+    std::vector<screen::listing> listings;
+    for (const auto &row : snapshot::accounts_from_json(read_file(accounts_path)))
+    {
+        auto itr_extras = std::lower_bound(extras.begin(), extras.end(), row.account4sale,
+                                           [](const snapshot::extras_row &e, uint64_t a) { return e.account4sale < a; });
+        listings.push_back({row.account4sale, itr_extras != extras.end() && itr_extras->account4sale == row.account4sale && itr_extras->screened});
+    }
+
+    return listings;
+}
+
+int main(int argc, char **argv)
+{
+
+    if (argc < 2)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    screen::rules rules;
+    std::string state_path, snapshot_path, accounts_path, extras_path, deferred_path, out_path, report_path;
+    unsigned threads = 0;
+    size_t batch_size = 100;
+    bool all = false;
+
+    if (!sdk::string_to_name(argv[1], rules.contract) || rules.contract == 0)
+    {
+        fprintf(stderr, "Invalid contract account %s\n", argv[1]);
+        return 1;
+    }
+
+    for (int i = 2; i < argc; ++i)
+    {
+        const bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--state") == 0 && has_value)
+            state_path = argv[++i];
+        else if (strcmp(argv[i], "--snapshot") == 0 && has_value)
+            snapshot_path = argv[++i];
+        else if (strcmp(argv[i], "--accounts") == 0 && has_value)
+            accounts_path = argv[++i];
+        else if (strcmp(argv[i], "--extras") == 0 && has_value)
+            extras_path = argv[++i];
+        else if (strcmp(argv[i], "--deferred") == 0 && has_value)
+            deferred_path = argv[++i];
+        else if (strcmp(argv[i], "--min-ram") == 0 && has_value)
+            rules.min_free_ram = strtoll(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--threads") == 0 && has_value)
+            threads = unsigned(strtoul(argv[++i], nullptr, 10));
+        else if (strcmp(argv[i], "--batch") == 0 && has_value)
+            batch_size = strtoull(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--out") == 0 && has_value)
+            out_path = argv[++i];
+        else if (strcmp(argv[i], "--report") == 0 && has_value)
+            report_path = argv[++i];
+        else if (strcmp(argv[i], "--all") == 0)
+            all = true;
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    // screenbatch takes at most MAX_SCREENBATCH accounts
+    if (state_path.empty() || snapshot_path.empty() == accounts_path.empty() || batch_size < 1 || batch_size > 100)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    try
+    {
+        sdk::thread_pool pool(threads);
+
+        auto start = std::chrono::steady_clock::now();
+        const std::vector<screen::listing> listings = snapshot_path.empty() ? json_listings(accounts_path, extras_path) : snapshot_listings(snapshot_path);
+        const std::vector<screen::account_state> states = screen::account_states_from_json(pool, read_file(state_path));
+        const std::vector<uint64_t> deferred = deferred_path.empty() ? std::vector<uint64_t>() : screen::deferred_accounts_from_json(read_file(deferred_path));
+        const double load_ms = elapsed_ms(start);
+
+        start = std::chrono::steady_clock::now();
+        const std::vector<screen::decision> decisions = screen::screen_listings(pool, rules, listings, states, deferred);
+        const double screen_ms = elapsed_ms(start);
+
+        write_file(out_path, screen::screenbatch_actions(rules.contract, decisions, batch_size, all));
+
+        size_t passed = 0, changed = 0;
+        std::string report = "account\toption\treasons\n";
+        for (const auto &d : decisions)
+        {
+            passed += d.option != 0;
+            changed += d.changed;
+            if (d.reasons != 0)
+            {
+                report += sdk::name_to_string(d.account4sale) + "\t" + std::to_string(d.option) + "\t" + screen::reason_names(d.reasons) + "\n";
+            }
+        }
+        if (!report_path.empty())
+        {
+            write_file(report_path, report);
+        }
+
+        fprintf(stderr, "%zu listings, %zu passed, %zu failed, %zu to push (%u threads, load %.1f ms, screen %.1f ms)\n",
+                decisions.size(), passed, decisions.size() - passed, all ? decisions.size() : changed, pool.size(), load_ms, screen_ms);
+    }
+    catch (const std::exception &e)
+    {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}
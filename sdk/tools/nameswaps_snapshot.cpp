@@ -0,0 +1,194 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+
+#include "nameswaps_sdk.hpp"
+#include "nameswaps_snapshot.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+using namespace nameswaps;
+
+static void usage(const char *program)
+{
+    fprintf(stderr,
+            "usage: %s convert <out.snap> [--accounts rows.json] [--extras rows.json] [--bids rows.json] [--stats rows.json]\n"
+            "       %s info <file.snap>\n"
+            "       %s find <file.snap> <account>\n",
+            program, program, program);
+}
+
+static std::string read_file(const std::string &path)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+    {
+        throw std::runtime_error("Cannot open " + path);
+    }
+
+    std::ostringstream text;
+    text << in.rdbuf();
+    return text.str();
+}
+
+// Asset as a decimal string with its symbol code
+static std::string asset_to_string(const snapshot::asset &a)
+{
+
+    const unsigned precision = unsigned(a.symbol & 0xff);
+    std::string digits = std::to_string(a.amount < 0 ? -a.amount : a.amount);
+    if (precision > 0)
+    {
+        if (digits.size() <= precision)
+        {
+            digits.insert(0, precision + 1 - digits.size(), '0');
+        }
+        digits.insert(digits.size() - precision, ".");
+    }
+
+    std::string code;
+    for (uint64_t sym = a.symbol >> 8; sym != 0; sym >>= 8)
+    {
+        code += char(sym & 0xff);
+    }
+
+    return (a.amount < 0 ? "-" : "") + digits + " " + code;
+}
+
+static int convert(int argc, char **argv)
+{
+
+    const std::string out = argv[2];
+
+    std::vector<snapshot::account_row> accounts;
+    std::vector<snapshot::extras_row> extras;
+    std::vector<snapshot::bids_row> bids;
+    std::vector<snapshot::stats_row> stats;
+
+    for (int i = 3; i < argc; i += 2)
+    {
+        if (i + 1 >= argc)
+        {
+            usage(argv[0]);
+            return 1;
+        }
+
+        const std::string json = read_file(argv[i + 1]);
+        if (strcmp(argv[i], "--accounts") == 0)
+            accounts = snapshot::accounts_from_json(json);
+        else if (strcmp(argv[i], "--extras") == 0)
+            extras = snapshot::extras_from_json(json);
+        else if (strcmp(argv[i], "--bids") == 0)
+            bids = snapshot::bids_from_json(json);
+        else if (strcmp(argv[i], "--stats") == 0)
+            stats = snapshot::stats_from_json(json);
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    printf("accounts %zu, extras %zu, bids %zu, stats %zu rows\n", accounts.size(), extras.size(), bids.size(), stats.size());
+    snapshot::write_snapshot(out, std::move(accounts), std::move(extras), std::move(bids), std::move(stats));
+    return 0;
+}
+
+static int info(const char *path)
+{
+
+    const auto start = std::chrono::steady_clock::now();
+    snapshot::reader snap(path);
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    printf("%s: %zu bytes, opened in %.3f ms\n", path, snap.file_size(), ms);
+    printf("  accounts %zu rows\n", snap.accounts().size());
+    printf("  extras   %zu rows\n", snap.extras().size());
+    printf("  bids     %zu rows\n", snap.bids().size());
+    printf("  stats    %zu rows\n", snap.stats().size());
+
+    for (size_t i = 0; i < snap.stats().size(); ++i)
+    {
+        const auto &stats = snap.stats();
+        printf("  stats[%llu]: listed %llu, purchased %llu, sales %s, fees %s\n",
+               (unsigned long long)stats.index[i], (unsigned long long)stats.num_listed[i], (unsigned long long)stats.num_purchased[i],
+               asset_to_string({stats.tot_sales_amount[i], stats.tot_sales_symbol[i]}).c_str(),
+               asset_to_string({stats.tot_fees_amount[i], stats.tot_fees_symbol[i]}).c_str());
+    }
+
+    return 0;
+}
+
+static int find(const char *path, const char *account_name)
+{
+
+    uint64_t account = 0;
+    if (!sdk::string_to_name(account_name, account))
+    {
+        fprintf(stderr, "Invalid account name %s\n", account_name);
+        return 1;
+    }
+
+    snapshot::reader snap(path);
+
+    const size_t row = snap.accounts().find(account);
+    if (row == snapshot::npos)
+    {
+        printf("%s is not listed\n", account_name);
+        return 1;
+    }
+
+    printf("%s: %s, paid to %s\n", account_name, asset_to_string(snap.accounts().saleprice(row)).c_str(),
+           sdk::name_to_string(snap.accounts().paymentaccnt[row]).c_str());
+
+    const size_t extras_row = snap.extras().find(account);
+    if (extras_row != snapshot::npos)
+    {
+        printf("  screened %d, votes %llu, message \"%.*s\"\n", int(snap.extras().screened[extras_row]),
+               (unsigned long long)snap.extras().numberofvotes[extras_row],
+               int(snap.extras().message[extras_row].size()), snap.extras().message[extras_row].data());
+    }
+
+    const size_t bids_row = snap.bids().find(account);
+    if (bids_row != snapshot::npos && snap.bids().bidprice_amount[bids_row] > 0)
+    {
+        printf("  bid %s by %s (decision %u)\n", asset_to_string(snap.bids().bidprice(bids_row)).c_str(),
+               sdk::name_to_string(snap.bids().bidder[bids_row]).c_str(), unsigned(snap.bids().bidaccepted[bids_row]));
+    }
+
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+
+    try
+    {
+        if (argc >= 3 && strcmp(argv[1], "convert") == 0)
+        {
+            return convert(argc, argv);
+        }
+        else if (argc == 3 && strcmp(argv[1], "info") == 0)
+        {
+            return info(argv[2]);
+        }
+        else if (argc == 4 && strcmp(argv[1], "find") == 0)
+        {
+            return find(argv[2], argv[3]);
+        }
+    }
+    catch (const std::exception &e)
+    {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+
+    usage(argv[0]);
+    return 1;
+}
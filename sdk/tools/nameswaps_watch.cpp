@@ -0,0 +1,180 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+
+#include "nameswaps_sdk.hpp"
+#include "nameswaps_watch.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+using namespace nameswaps;
+
+static void usage(const char *program)
+{
+    fprintf(stderr,
+            "usage: %s <watchlists.txt> <events.txt> [--threads N] [--precision digits] [--out matches.tsv]\n"
+            "  watchlist line: <id> <pattern> [len=min-max] [max=price] [on=sell,update,proposebid]\n"
+            "  event line:     <sell|update|proposebid> <account> <price>\n",
+            program);
+}
+
+// Non-empty lines that are not comments, with their line numbers
+static std::vector<std::pair<size_t, std::string>> read_lines(const std::string &path)
+{
+    std::ifstream in(path);
+    if (!in)
+    {
+        throw std::runtime_error("Cannot open " + path);
+    }
+
+    std::vector<std::pair<size_t, std::string>> lines;
+    std::string line;
+    for (size_t number = 1; std::getline(in, line); ++number)
+    {
+        const size_t start = line.find_first_not_of(" \t\r");
+        if (start != std::string::npos && line[start] != '#')
+        {
+            lines.emplace_back(number, line);
+        }
+    }
+
+    return lines;
+}
+
+int main(int argc, char **argv)
+{
+
+    if (argc < 3)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    unsigned threads = 0;
+    unsigned precision = 8;
+    std::string out_path;
+    for (int i = 3; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            threads = unsigned(strtoul(argv[++i], nullptr, 10));
+        else if (strcmp(argv[i], "--precision") == 0 && i + 1 < argc)
+            precision = unsigned(strtoul(argv[++i], nullptr, 10));
+        else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+            out_path = argv[++i];
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    try
+    {
+        // ----------------------------------------------
+        // Compile the watchlists
+        // ----------------------------------------------
+
+        std::vector<std::string> ids;
+        std::vector<watch::watchlist> watchlists;
+        for (const auto &line : read_lines(argv[1]))
+        {
+            ids.emplace_back();
+            try
+            {
+                watchlists.push_back(watch::parse_watchlist(line.second, precision, ids.back()));
+            }
+            catch (const std::invalid_argument &e)
+            {
+                throw std::runtime_error(std::string(argv[1]) + ":" + std::to_string(line.first) + ": " + e.what());
+            }
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        const watch::matcher matcher(watchlists);
+        const double build_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        // ----------------------------------------------
+        // Match the event stream
+        // ----------------------------------------------
+
+        const auto lines = read_lines(argv[2]);
+        std::vector<watch::event> events;
+        events.reserve(lines.size());
+        for (const auto &line : lines)
+        {
+            try
+            {
+                events.push_back(watch::parse_event(line.second, precision));
+            }
+            catch (const std::invalid_argument &e)
+            {
+                throw std::runtime_error(std::string(argv[2]) + ":" + std::to_string(line.first) + ": " + e.what());
+            }
+        }
+
+        std::vector<std::vector<uint32_t>> matches(events.size());
+        std::vector<double> latency_us(events.size());
+
+        sdk::thread_pool pool(threads);
+        start = std::chrono::steady_clock::now();
+        pool.parallel_for(events.size(), 64, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+            {
+                const auto event_start = std::chrono::steady_clock::now();
+                matcher.match(events[i], matches[i]);
+                latency_us[i] = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - event_start).count();
+            }
+        });
+        const double match_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        // ----------------------------------------------
+        // Report
+        // ----------------------------------------------
+
+        FILE *out = out_path.empty() ? stdout : fopen(out_path.c_str(), "w");
+        if (out == nullptr)
+        {
+            throw std::runtime_error("Cannot write " + out_path);
+        }
+
+        size_t total = 0;
+        for (size_t i = 0; i < events.size(); ++i)
+        {
+            std::sort(matches[i].begin(), matches[i].end());
+            total += matches[i].size();
+
+            const std::string account = sdk::name_to_string(events[i].account);
+            for (const uint32_t w : matches[i])
+            {
+                fprintf(out, "%zu\t%s\t%s\t%.3f\n", lines[i].first, account.c_str(), ids[w].c_str(), latency_us[i]);
+            }
+        }
+
+        if (out != stdout)
+        {
+            fclose(out);
+        }
+
+        std::vector<double> sorted = latency_us;
+        std::sort(sorted.begin(), sorted.end());
+        auto percentile = [&](double p) { return sorted.empty() ? 0.0 : sorted[std::min(sorted.size() - 1, size_t(p * sorted.size()))]; };
+
+        fprintf(stderr, "%zu watchlists (%zu nodes, %.1f MB) compiled in %.1f ms\n", watchlists.size(), matcher.nodes(), matcher.memory_bytes() / 1e6, build_ms);
+        fprintf(stderr, "%zu events, %zu matches in %.1f ms on %u threads. Latency p50 %.2f us, p99 %.2f us, max %.2f us\n",
+                events.size(), total, match_ms, pool.size(), percentile(0.5), percentile(0.99), sorted.empty() ? 0.0 : sorted.back());
+    }
+    catch (const std::exception &e)
+    {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}
@@ -5,6 +5,8 @@
 
 #include "../include/eosnameswaps.hpp"
 
+#include <cmath>
+
 namespace eosio
 {
 
@@ -69,6 +71,7 @@ void eosnameswaps::sell(name account4sale,
 
     // Place data in accounts table. Seller pays for ram storage
     _accounts.emplace(account4sale, [&](auto &s) {
+        upgrade_row(s);
         s.account4sale = account4sale;
         s.saleprice = saleprice;
         s.paymentaccnt = paymentaccnt;
@@ -76,6 +79,7 @@ void eosnameswaps::sell(name account4sale,
 
     // Place data in extras table. Seller pays for ram storage
     _extras.emplace(account4sale, [&](auto &s) {
+        upgrade_row(s);
         s.account4sale = account4sale;
         s.screened = false;
         s.numberofvotes = 0;
@@ -85,20 +89,71 @@ void eosnameswaps::sell(name account4sale,
 
     // Place data in bids table. Bidder pays for ram storage
     _bids.emplace(account4sale, [&](auto &s) {
+        upgrade_row(s);
         s.account4sale = account4sale;
         s.bidaccepted = 1;
         s.bidprice = asset(0, network_symbol);
         s.bidder = name("");
     });
 
+    // Place data in catalog table. Seller pays for ram storage
+    catalog_add(account4sale, saleprice, account4sale);
+
+    // Place data in screening queue. Seller pays for ram storage
+    _screening.emplace(account4sale, [&](auto &s) {
+        s.account4sale = account4sale;
+        s.listed = current_time_point();
+    });
+
+    // Place data in changes table. Seller pays for ram storage
+    stamp_change(account4sale, account4sale);
+
     // Place data in stats table. Contract pays for ram storage
     auto itr_stats = _stats.find(0);
     _stats.modify(itr_stats, _self, [&](auto &s) {
+        upgrade_row(s);
         s.num_listed++;
     });
 
     // Send message
     send_message(paymentaccnt, string("EOSNameSwaps: Your account ") + name{account4sale}.to_string() + string(" has been listed for sale. Keep an eye out for bids, and don't forget to vote for accounts you like!"));
+
+    // ----------------------------------------------
+    // Fill a wanted offer
+    // ----------------------------------------------
+
+    // Highest offer for this account (last entry below the next account in the index)
+    auto wanted_bytarget = _wanted.get_index<name("bytarget")>();
+    auto itr_wanted = wanted_bytarget.upper_bound((uint128_t(account4sale.value) << 64) | UINT64_MAX);
+    if (itr_wanted == wanted_bytarget.begin())
+    {
+        return;
+    }
+
+    --itr_wanted;
+    if (itr_wanted->account4sale != account4sale || itr_wanted->price < saleprice)
+    {
+        return;
+    }
+
+    const name buyer = itr_wanted->buyer;
+    const asset refund = itr_wanted->price - saleprice;
+
+    // Erase the offer from the wanted table
+    wanted_bytarget.erase(itr_wanted);
+
+    // Refund the part of the offer above the sale price
+    if (refund.amount > 0)
+    {
+        action(
+            permission_level{_self, name("active")},
+            name("eosio.token"), name("transfer"),
+            std::make_tuple(_self, buyer, refund, string("EOSNameSwaps: Wanted offer refund: ") + account4sale.to_string()))
+            .send();
+    }
+
+    // Settle at the sale price. The account is handed to the buyer's own permissions
+    buy_saleprice(account4sale, buyer, saleprice, "None", "None", "");
 }
 
 // Action: Buy an account listed for sale
@@ -125,7 +180,7 @@ void eosnameswaps::buy(name from,
 
     // Check the buy code is valid
     const string buy_code = memo.substr(0, 3);
-    check(buy_code == "cn:" || buy_code == "sp:" || buy_code == "mk:", "Buy Error: Malformed buy string.");
+    check(nameswaps::valid_buy_code(buy_code), "Buy Error: Malformed buy string.");
 
     // Check the transfer is valid
     check(quantity.symbol == network_symbol, (string("Buy Error: You must pay in ") + symbol_name + string(".")).c_str());
@@ -133,35 +188,57 @@ void eosnameswaps::buy(name from,
 
     // ----------------------------------------------
 
-    // Strip buy code from memo
-    const string memo2 = memo.substr(3);
+    // Wanted offers only carry the account name
+    if (buy_code == "wt:")
+    {
+        const name account_name = name(memo.substr(3));
+        check(account_name.to_string() == memo.substr(3), "Wanted Error: Malformed account name.");
+
+        buy_wanted(account_name, from, quantity);
+        return;
+    }
 
-    // Find the length of the account name
-    int name_length = 0;
-    for (int lp = 1; lp <= 12; ++lp)
+    // Credit deposits carry no account name
+    if (buy_code == "cr:")
     {
-        if (memo2[lp] == ',')
-        {
-            name_length = lp;
-            break;
-        }
+        buy_credit(from, quantity);
+        return;
+    }
+
+    // Baskets list the keys first, then the account names
+    if (buy_code == "bk:")
+    {
+        buy_basket(from, quantity, memo.substr(3));
+        return;
+    }
+
+    // Relists carry the new sale price instead of keys, as the account stays with the contract
+    if (buy_code == "rl:")
+    {
+        nameswaps::relist_memo relist;
+        const char *relist_error = nameswaps::parse_relist_memo(memo, relist);
+        check(relist_error == nullptr, relist_error);
+
+        int64_t newprice = 0;
+        check(nameswaps::memo_amount(relist.saleprice, network_symbol.precision(), newprice), "Relist Error: Malformed sale price.");
+
+        buy_relist(name(relist.account_name), from, quantity, asset(newprice, network_symbol), string(relist.referrer));
+        return;
     }
 
-    // Check the name length is valid
-    check(name_length > 0, "Buy Error: Malformed buy name.");
+    // Split the memo into the account name, keys and referrer (same grammar as the host SDK)
+    nameswaps::buy_memo parsed;
+    const char *memo_error = nameswaps::parse_buy_memo(memo, parsed);
+    check(memo_error == nullptr, memo_error);
 
     // Extract account to buy from memo
-    const name account_name = name(memo2.substr(0, name_length));
+    const name account_name = name(parsed.account_name);
 
     // Extract keys
-    const string owner_key = memo2.substr(name_length + 1, KEY_LENGTH);
-    const string active_key = memo2.substr(name_length + 2 + KEY_LENGTH, KEY_LENGTH);
+    const string owner_key = string(parsed.owner_key);
+    const string active_key = string(parsed.active_key);
 
-    string referrer = "";
-    if (memo2.length() > name_length + 3 + 2 * KEY_LENGTH && memo2.length() <= name_length + 3 + 2 * KEY_LENGTH + 12)
-    {
-        referrer = memo2.substr(name_length + 3 + 2 * KEY_LENGTH);
-    }
+    const string referrer = string(parsed.referrer);
 
     // Call the required function
     if (buy_code == "cn:")
@@ -178,6 +255,47 @@ void eosnameswaps::buy(name from,
     }
 }
 
+void eosnameswaps::buy_wanted(const name account_name, const name from, const asset quantity)
+{
+
+    // ----------------------------------------------
+    // Valid transaction checks
+    // ----------------------------------------------
+
+    // Only existing accounts can be listed, so only they can fill an offer
+    check(account_name != name(""), "Wanted Error: No account name given.");
+    check(account_name != from, "Wanted Error: You cannot make an offer for your own account.");
+    check(is_account(account_name), "Wanted Error: That account does not exist.");
+
+    // Listed accounts are bought directly
+    check(_accounts.find(account_name.value) == _accounts.end(), "Wanted Error: That account is already for sale. Buy it or propose a bid.");
+
+    // The contract pays for the offer rows (a transfer notification cannot bill the buyer), so offers are capped per buyer
+    auto wanted_bybuyer = _wanted.get_index<name("bybuyer")>();
+    uint8_t offers = 0;
+    for (auto itr_wanted = wanted_bybuyer.lower_bound(from.value); itr_wanted != wanted_bybuyer.end() && itr_wanted->buyer == from && offers < WANTED_MAX_OFFERS; ++itr_wanted)
+    {
+        offers++;
+    }
+    check(offers < WANTED_MAX_OFFERS, "Wanted Error: You have too many open offers. Cancel one first.");
+
+    // Check the offer is at least the minimum sale price
+    check(quantity >= asset(10000, network_symbol), (string("Wanted Error: The minimum offer is 1.0000 ") + symbol_name + string(".")).c_str());
+
+    // ----------------------------------------------
+
+    // Place data in wanted table. Contract pays for ram storage
+    _wanted.emplace(_self, [&](auto &s) {
+        s.id = _wanted.available_primary_key();
+        s.account4sale = account_name;
+        s.buyer = from;
+        s.price = quantity;
+    });
+
+    // Send message
+    send_message(from, string("EOSNameSwaps: Your offer for ") + account_name.to_string() + string(" is escrowed. It will be filled if the account is listed at or below your offer."));
+}
+
 void eosnameswaps::buy_custom(const name account_name, const name from, const asset quantity, const string owner_key, const string active_key)
 {
 
@@ -188,98 +306,11 @@ void eosnameswaps::buy_custom(const name account_name, const name from, const as
     string suffix = (account_name).to_string().substr(name_length - 2, 2);
 
     // Currently supported suffixes
-    check(suffix == ".e" || suffix == ".x" || suffix == ".y" || suffix == ".z", "Custom Error: That is not a valid suffix.");
+    check(nameswaps::valid_custom_suffix(suffix), "Custom Error: That is not a valid suffix.");
 
     // Custom name saleprice
-    asset saleprice = asset(0, network_symbol);
-
-    if (suffix == ".e")
-    {
-
-        switch (name_length)
-        {
-        case 7:
-            saleprice.amount = 57000;
-            break;
-        case 8:
-            saleprice.amount = 47000;
-            break;
-        case 9:
-            saleprice.amount = 37000;
-            break;
-        case 10:
-            saleprice.amount = 27000;
-            break;
-        case 11:
-            saleprice.amount = 17000;
-            break;
-        case 12:
-            saleprice.amount = 8000;
-            break;
-        default:
-            check(1 == 0, "Custom Error: Incorrect custom name length");
-            break;
-        }
-    }
-    else if (suffix == ".x")
-    {
-
-        switch (name_length)
-        {
-        case 7:
-            saleprice.amount = 67000;
-            break;
-        case 8:
-            saleprice.amount = 57000;
-            break;
-        case 9:
-            saleprice.amount = 47000;
-            break;
-        case 10:
-            saleprice.amount = 37000;
-            break;
-        case 11:
-            saleprice.amount = 27000;
-            break;
-        case 12:
-            saleprice.amount = 17000;
-            break;
-        default:
-            check(1 == 0, "Custom Error: Incorrect custom name length");
-            break;
-        }
-    }
-    else if (suffix == ".y" || suffix == ".z")
-    {
-
-        switch (name_length)
-        {
-        case 6:
-            saleprice.amount = 507000;
-            break;
-        case 7:
-            saleprice.amount = 57000;
-            break;
-        case 8:
-            saleprice.amount = 47000;
-            break;
-        case 9:
-            saleprice.amount = 37000;
-            break;
-        case 10:
-            saleprice.amount = 27000;
-            break;
-        case 11:
-            saleprice.amount = 17000;
-            break;
-        case 12:
-            saleprice.amount = 8000;
-            break;
-        default:
-            check(1 == 0, "Custom Error: Incorrect custom name length");
-            break;
-        }
-    }
+    const asset saleprice = asset(nameswaps::custom_price(suffix, name_length), network_symbol);
+    check(saleprice.amount > 0, "Custom Error: Incorrect custom name length");
 
     // Check the correct amount has been transferred
     check(quantity == saleprice, "Custom Error: Wrong amount transferred.");
@@ -305,6 +336,7 @@ void eosnameswaps::buy_custom(const name account_name, const name from, const as
 
     // Update stats table
     _stats.modify(_stats.find(index), _self, [&](auto &s) {
+        upgrade_row(s);
         s.num_purchased++;
         s.tot_sales += saleprice;
     });
@@ -341,14 +373,90 @@ void eosnameswaps::make_account(const name account_name, const name from, const
     // Valid transaction checks
     // ----------------------------------------------
 
-    // Check the correct amount has been transferred
-    check(quantity == newaccountfee, "Custom Error: Wrong amount transferred.");
+    // New account fee at the current RAM price
+    const asset newaccountfee = newaccount_price();
+
+    // Check enough has been transferred
+    check(quantity >= newaccountfee, (string("Custom Error: Wrong amount transferred. The new account fee is ") + newaccountfee.to_string() + string(".")).c_str());
 
     // ----------------------------------------------
 
     authority owner_auth = keystring_authority(owner_key_str);
     authority active_auth = keystring_authority(active_key_str);
 
+    // Create account
+    create_account(account_name, owner_auth, active_auth, _config.get_or_default(configtable{newaccountbytes, 0}).newaccount_bytes);
+
+    // Refund the part of the transfer above the fee
+    if (quantity > newaccountfee)
+    {
+        action(
+            permission_level{_self, name("active")},
+            name("eosio.token"), name("transfer"),
+            std::make_tuple(_self, from, quantity - newaccountfee, string("EOSNameSwaps: New account fee refund: ") + account_name.to_string()))
+            .send();
+    }
+
+    // Stats table index
+    uint64_t index = 5;
+
+    // Update stats table
+    _stats.modify(_stats.find(index), _self, [&](auto &s) {
+        upgrade_row(s);
+        s.num_purchased++;
+        s.tot_sales += newaccountfee;
+    });
+}
+
+// Cost of a new account at the current RAM price
+asset eosnameswaps::newaccount_price()
+{
+
+    const configtable config = _config.get_or_default(configtable{newaccountbytes, 0});
+
+    // Read the RAM market once
+    eosio::multi_index<name("rammarket"), exchange_state> rammarket(name("eosio"), name("eosio").value);
+    auto itr_rammarket = rammarket.find(symbol("RAMCORE", 4).raw());
+    check(itr_rammarket != rammarket.end(), "Custom Error: The RAM market is not available.");
+
+    // Bancor input for the bytes plus the 0.5% RAM fee (as in eosio::buyrambytes)
+    const double ram_reserve = itr_rammarket->base.balance.amount;
+    const double eos_reserve = itr_rammarket->quote.balance.amount;
+    const int64_t ram_cost = int64_t((eos_reserve * config.newaccount_bytes) / (ram_reserve - config.newaccount_bytes) / double(0.995));
+
+    // RAM, CPU & NET plus the margin
+    asset newaccountfee = asset(ram_cost + 1, network_symbol) + newaccountcpu + newaccountnet;
+    newaccountfee.amount += int64_t(static_cast<__int128>(newaccountfee.amount) * config.newaccount_margin / 10000);
+
+    return newaccountfee;
+}
+
+void eosnameswaps::buy_credit(const name from, const asset quantity)
+{
+
+    // Check the deposit pays for at least one account
+    check(quantity >= newaccount_price(), "Credit Error: The deposit must cover at least one account.");
+
+    // Place data in credits table. Contract pays for ram storage
+    auto itr_credits = _credits.find(from.value);
+    if (itr_credits == _credits.end())
+    {
+        _credits.emplace(_self, [&](auto &s) {
+            s.owner = from;
+            s.balance = quantity;
+        });
+    }
+    else
+    {
+        _credits.modify(itr_credits, _self, [&](auto &s) {
+            s.balance += quantity;
+        });
+    }
+}
+
+void eosnameswaps::create_account(const name account_name, const authority &owner_auth, const authority &active_auth, const uint32_t ram_bytes)
+{
+
     // Create account
     action(
         permission_level{_self, name("active")},
@@ -356,11 +464,11 @@ void eosnameswaps::make_account(const name account_name, const name from, const
         std::make_tuple(_self, account_name, owner_auth, active_auth))
         .send();
 
-    // Buy ram
+    // Buy the exact ram bytes
     action(
         permission_level{_self, name("active")},
-        name("eosio"), name("buyram"),
-        std::make_tuple(_self, account_name, newaccountram))
+        name("eosio"), name("buyrambytes"),
+        std::make_tuple(_self, account_name, ram_bytes))
         .send();
 
     // Delegate CPU/NET
@@ -369,15 +477,6 @@ void eosnameswaps::make_account(const name account_name, const name from, const
         name("eosio"), name("delegatebw"),
         std::make_tuple(_self, account_name, newaccountnet, newaccountcpu, 1))
         .send();
-
-    // Stats table index
-    uint64_t index = 5;
-
-    // Update stats table
-    _stats.modify(_stats.find(index), _self, [&](auto &s) {
-        s.num_purchased++;
-        s.tot_sales += newaccountfee;
-    });
 }
 
 authority eosnameswaps::keystring_authority(string key_str)
@@ -408,46 +507,41 @@ authority eosnameswaps::keystring_authority(string key_str)
     return ret_authority;
 }
 
-void eosnameswaps::buy_saleprice(const name account_to_buy, const name from, const asset quantity, const string owner_key, const string active_key, const string referrer)
+// Check the price of a listed account and pay out the fees
+salequote eosnameswaps::settle_sale(const name account_to_buy, const name from, const asset quantity, const string referrer)
 {
 
     // ----------------------------------------------
     // Sale/Bid price
     // ----------------------------------------------
 
+    // Reserved listings can only be bought by the reserving buyer. Checked first, as it is the cheapest way to lose a race
+    check_reserve(account_to_buy, from);
+
     // Check the account is available to buy
     auto itr_accounts = _accounts.find(account_to_buy.value);
     check(itr_accounts != _accounts.end(), (string("Buy Error: Account ") + account_to_buy.to_string() + string(" is not for sale.")).c_str());
 
-    // Sale price
-    auto saleprice = itr_accounts->saleprice;
+    // Sale price (dutch auctions are priced from the current time)
+    const asset listprice = listing_price(account_to_buy, itr_accounts->saleprice);
+
+    // The accepted bidder pays the bid price (the rule the quote action uses). Anyone can pay the listing price
+    const asset saleprice = quantity == listprice ? listprice : buyer_price(account_to_buy, listprice, from);
 
-    // Check the correct amount of EOS was transferred
+    // Explain why a transfer of the bid price is not accepted
     if (quantity != saleprice)
     {
         auto itr_bids = _bids.find(account_to_buy.value);
-
-        // Current bid decision by seller
-        const int bid_decision = itr_bids->bidaccepted;
-
-        if (quantity == itr_bids->bidprice)
+        if (itr_bids != _bids.end() && quantity == itr_bids->bidprice)
         {
-
-            // Check the bid has been accepted
-            if (bid_decision == BID_ACCEPTED)
-            {
-                // Check the bid has not been rejected
-                check(bid_decision != BID_REJECTED, "Buy Error: The bid has been rejected. Bid higher.");
-
-                // Check the bid has been decided
-                check(bid_decision != BID_UNDECIDED, "Buy Error: The bid has not been accepted or rejected yet.");
-            }
-
-            // Check the bid is from the accepted bidder
+            // Check the bid is from the bidder
             check(itr_bids->bidder == from, "Buy Error: Only the accepted bidder can purchase the account at the bid price.");
 
-            // Lower sale price to the bid price for the bidder only
-            saleprice = itr_bids->bidprice;
+            // Check the bid has not been rejected
+            check(itr_bids->bidaccepted != BID_REJECTED, "Buy Error: The bid has been rejected. Bid higher.");
+
+            // Check the bid has been decided
+            check(itr_bids->bidaccepted != BID_UNDECIDED, "Buy Error: The bid has not been accepted or rejected yet.");
         }
     }
 
@@ -457,29 +551,39 @@ void eosnameswaps::buy_saleprice(const name account_to_buy, const name from, con
     // Seller, Contract, & Referrer fees
     // ----------------------------------------------
 
-    auto sellerfee = asset(0, network_symbol);
-    auto contractfee = asset(0, network_symbol);
-
-    // Fee amounts
-    contractfee.amount = int(saleprice.amount * contract_pc);
-    sellerfee.amount = saleprice.amount - contractfee.amount;
+    // Same fee model as the quote action
+    const salequote settlement = sale_settlement(account_to_buy, saleprice, referrer.length() > 0 ? name(referrer) : name(""));
 
-    // Look up the referrer account
-    if (referrer.length() > 0)
+    // Transfer EOS from contract to referrer fees account
+    if (settlement.referrerfee.amount > 0)
     {
-        auto itr_referrer = _referrer.find(name(referrer).value);
-        if (itr_referrer != _referrer.end())
+        action(
+            permission_level{_self, name("active")},
+            name("eosio.token"), name("transfer"),
+            std::make_tuple(_self, settlement.ref_account, settlement.referrerfee, string("EOSNameSwaps: Account referrer fee: ") + itr_accounts->account4sale.to_string()))
+            .send();
+
+        // Place data in refstats table. Contract pays for ram storage
+        const name ref_name = name(referrer);
+        auto itr_refstats = _refstats.find(ref_name.value);
+        if (itr_refstats == _refstats.end())
         {
-
-            auto referrerfee = asset(int(referrer_pc * contractfee.amount), network_symbol);
-            contractfee.amount -= referrerfee.amount;
-
-            // Transfer EOS from contract to referrer fees account
-            action(
-                permission_level{_self, name("active")},
-                name("eosio.token"), name("transfer"),
-                std::make_tuple(_self, itr_referrer->ref_account, referrerfee, string("EOSNameSwaps: Account referrer fee: ") + itr_accounts->account4sale.to_string()))
-                .send();
+            _refstats.emplace(_self, [&](auto &s) {
+                s.ref_name = ref_name;
+                s.num_sales = 1;
+                s.volume = saleprice;
+                s.fees = settlement.referrerfee;
+                s.last_sale = current_time_point();
+            });
+        }
+        else
+        {
+            _refstats.modify(itr_refstats, _self, [&](auto &s) {
+                s.num_sales++;
+                s.volume += saleprice;
+                s.fees += settlement.referrerfee;
+                s.last_sale = current_time_point();
+            });
         }
     }
 
@@ -487,148 +591,604 @@ void eosnameswaps::buy_saleprice(const name account_to_buy, const name from, con
     action(
         permission_level{_self, name("active")},
         name("eosio.token"), name("transfer"),
-        std::make_tuple(_self, feesaccount, contractfee, string("EOSNameSwaps: Account contract fee: ") + itr_accounts->account4sale.to_string()))
+        std::make_tuple(_self, feesaccount, settlement.contractfee, string("EOSNameSwaps: Account contract fee: ") + itr_accounts->account4sale.to_string()))
         .send();
 
-    // Transfer EOS from contract to seller minus the contract fees
-    action(
-        permission_level{_self, name("active")},
-        name("eosio.token"), name("transfer"),
-        std::make_tuple(_self, itr_accounts->paymentaccnt, sellerfee, string("EOSNameSwaps: Account seller fee: ") + itr_accounts->account4sale.to_string()))
-        .send();
+    // Transfer EOS from contract to seller (or the shop's payment accounts) minus the contract fees
+    std::map<name, asset> payouts;
+    seller_payouts(account_to_buy, itr_accounts->paymentaccnt, settlement.sellerfee, payouts);
+    for (const auto &payout : payouts)
+    {
+        action(
+            permission_level{_self, name("active")},
+            name("eosio.token"), name("transfer"),
+            std::make_tuple(_self, payout.first, payout.second, string("EOSNameSwaps: Account seller fee: ") + itr_accounts->account4sale.to_string()))
+            .send();
+    }
+
+    return settlement;
+}
+
+// Buy an account listed for sale
+void eosnameswaps::buy_saleprice(const name account_to_buy, const name from, const asset quantity, const string owner_key, const string active_key, const string referrer)
+{
+
+    // ----------------------------------------------
+    // Sale/Bid price and fees
+    // ----------------------------------------------
+
+    const salequote settlement = settle_sale(account_to_buy, from, quantity, referrer);
+    const asset saleprice = settlement.saleprice;
 
     // ----------------------------------------------
     // Update account owner
     // ----------------------------------------------
 
     // Remove contract@owner permissions and replace with buyer@active account and the supplied key
-    account_auth(itr_accounts->account4sale, from, name("active"), name("owner"), active_key);
+    account_auth(account_to_buy, from, name("active"), name("owner"), active_key);
 
     // Remove seller@active permissions and replace with buyer@owner account and the supplied key
-    account_auth(itr_accounts->account4sale, from, name("owner"), name(""), owner_key);
+    account_auth(account_to_buy, from, name("owner"), name(""), owner_key);
 
     // ----------------------------------------------
     // Cleanup
     // ----------------------------------------------
 
-    // Erase account from the accounts table
-    _accounts.erase(itr_accounts);
+    // Erase account from the listing tables
+    erase_listing(account_to_buy);
 
-    // Erase account from the extras table
-    auto itr_extras = _extras.find(account_to_buy.value);
-    _extras.erase(itr_extras);
+    // Place sale in categories table. Contract pays for ram storage
+    catalog_sale(account_to_buy, saleprice);
 
-    // Erase account from the bids table
-    auto itr_bids = _bids.find(account_to_buy.value);
-    _bids.erase(itr_bids);
+    // Place sale in recent sales feed. Contract pays for ram storage
+    record_sale(account_to_buy, from, saleprice);
 
     // Place data in stats table. Contract pays for ram storage
     auto itr_stats = _stats.find(0);
     _stats.modify(itr_stats, _self, [&](auto &s) {
+        upgrade_row(s);
         s.num_listed--;
         s.num_purchased++;
         s.tot_sales += saleprice;
-        s.tot_fees += contractfee;
+        s.tot_fees += settlement.contractfee;
     });
 
     // Send message
     send_message(from, string("EOSNameSwaps: You have successfully bought the account ") + name{account_to_buy}.to_string() + string(". Please come again."));
 }
 
-// Action: Remove a listed account from sale
-void eosnameswaps::cancel(name account4sale,
-                          string owner_key_str,
-                          string active_key_str)
+// Buy an account listed for sale and list it again at a new price
+void eosnameswaps::buy_relist(const name account_to_buy, const name from, const asset quantity, const asset newprice, const string referrer)
 {
 
     // ----------------------------------------------
-    // Auth checks
+    // Valid transaction checks
     // ----------------------------------------------
 
-    // Check an account with that name is listed for sale
-    auto itr_accounts = _accounts.find(account4sale.value);
-    check(itr_accounts != _accounts.end(), "Cancel Error: That account name is not listed for sale");
-
-    // Only the payment account can cancel the sale (the contract has the owner key)
-    check(has_auth(itr_accounts->paymentaccnt) || has_auth(_self), "Cancel Error: Only the payment account can cancel the sale.");
+    check(newprice >= asset(10000, network_symbol), (string("Relist Error: Sale price must be at least 1 ") + symbol_name + string(". Ex: 1.0000 ") + symbol_name + string(".")).c_str());
+    check(from != account_to_buy, "Relist Error: The payment account cannot be the account for sale!");
 
     // ----------------------------------------------
-    // Update account owners
+    // Sale/Bid price and fees
     // ----------------------------------------------
 
-    // Change auth from contract@active to submitted active key
-    account_auth(account4sale, itr_accounts->paymentaccnt, name("active"), name("owner"), active_key_str);
-
-    // Change auth from contract@owner to submitted owner key
-    account_auth(account4sale, itr_accounts->paymentaccnt, name("owner"), name(""), owner_key_str);
+    const salequote settlement = settle_sale(account_to_buy, from, quantity, referrer);
+    const asset saleprice = settlement.saleprice;
 
     // ----------------------------------------------
-    // Cleanup
+    // Relist in place
     // ----------------------------------------------
 
-    // Erase account from accounts table
-    _accounts.erase(itr_accounts);
+    // The contract keeps owner and active, so there is no updateauth, and the rows keep their size and payer.
+    // Rows are only modified with same_payer (the notification cannot bill the buyer for ram)
 
-    // Erase account from the extras table
-    auto itr_extras = _extras.find(account4sale.value);
-    _extras.erase(itr_extras);
+    // The buyer is paid for the next sale
+    auto itr_accounts = _accounts.find(account_to_buy.value);
+    _accounts.modify(itr_accounts, same_payer, [&](auto &s) {
+        s.saleprice = newprice;
+        s.paymentaccnt = from;
+    });
 
-    // Erase account from the bids table
-    auto itr_bids = _bids.find(account4sale.value);
-    _bids.erase(itr_bids);
+    // Votes and the message belong to the previous sale. The account has not changed hands, so the screening stands
+    auto itr_extras = _extras.find(account_to_buy.value);
+    _extras.modify(itr_extras, same_payer, [&](auto &s) {
+        s.numberofvotes = 0;
+        s.last_voter = name("");
+        s.message = string("");
+    });
 
-    // Place data in stats table. Contract pays for ram storage
+    // Bids were for the previous sale (the bid history is kept)
+    auto itr_bids = _bids.find(account_to_buy.value);
+    _bids.modify(itr_bids, same_payer, [&](auto &s) {
+        s.bidaccepted = 1;
+        s.bidprice = asset(0, network_symbol);
+        s.bidder = name("");
+    });
+
+    // The trending score was built from the previous sale's votes and bids. The next vote or bid starts a new one
+    auto itr_trending = _trending.find(account_to_buy.value);
+    if (itr_trending != _trending.end())
+    {
+        _trending.erase(itr_trending);
+    }
+
+    // Record the sale and the new price in the category catalog
+    catalog_sale(account_to_buy, saleprice);
+    catalog_update(account_to_buy, newprice);
+
+    // The new price is a fixed price, the reservation is used and the seller's shop no longer applies
+    auto itr_dutch = _dutch.find(account_to_buy.value);
+    if (itr_dutch != _dutch.end())
+    {
+        _dutch.erase(itr_dutch);
+    }
+
+    auto itr_reserves = _reserves.find(account_to_buy.value);
+    if (itr_reserves != _reserves.end())
+    {
+        _reserves.erase(itr_reserves);
+    }
+
+    auto itr_shopitems = _shopitems.find(account_to_buy.value);
+    if (itr_shopitems != _shopitems.end())
+    {
+        _shopitems.erase(itr_shopitems);
+    }
+
+    stamp_change(account_to_buy, _self);
+
+    // Place sale in recent sales feed. Contract pays for ram storage
+    record_sale(account_to_buy, from, saleprice);
+
+    // Place data in stats table (the account stays listed). Contract pays for ram storage
     auto itr_stats = _stats.find(0);
     _stats.modify(itr_stats, _self, [&](auto &s) {
-        s.num_listed--;
+        upgrade_row(s);
+        s.num_purchased++;
+        s.tot_sales += saleprice;
+        s.tot_fees += settlement.contractfee;
     });
 
     // Send message
-    send_message(itr_accounts->paymentaccnt, string("EOSNameSwaps: You have successfully cancelled the sale of the account ") + name{account4sale}.to_string() + string(". Please come again."));
+    send_message(from, string("EOSNameSwaps: You have bought the account ") + name{account_to_buy}.to_string() + string(" and listed it for ") + newprice.to_string() + string(". The sale proceeds will be paid to you."));
 }
 
-// Action: Remove a listed account from sale
-void eosnameswaps::remove(name account4sale)
+void eosnameswaps::buy_basket(const name from, const asset quantity, const string basket)
 {
 
     // ----------------------------------------------
-    // Auth checks
+    // Parse the basket
     // ----------------------------------------------
 
-    // Check an account with that name is listed for sale
-    auto itr_accounts = _accounts.find(account4sale.value);
-    check(itr_accounts != _accounts.end(), "Cancel Error: That account name is not listed for sale");
-
-    // Only the contract account can remove the sale (the contract has the owner key)
-    check(has_auth(_self), "Cancel Error: Only the contract account can remove the sale.");
-
-    // Cleanup
-    // ----------------------------------------------
+    // Basket format: owner_key,active_key,account1,account2,...
+    check(basket.length() > 2 * KEY_LENGTH + 2 && basket[KEY_LENGTH] == ',' && basket[2 * KEY_LENGTH + 1] == ',', "Basket Error: Malformed basket string.");
 
-    // Erase account from accounts table
-    _accounts.erase(itr_accounts);
+    const string owner_key = basket.substr(0, KEY_LENGTH);
+    const string active_key = basket.substr(KEY_LENGTH + 1, KEY_LENGTH);
 
-    // Erase account from the extras table
-    auto itr_extras = _extras.find(account4sale.value);
-    _extras.erase(itr_extras);
+    std::vector<name> accounts_to_buy;
+    size_t start = 2 * KEY_LENGTH + 2;
+    while (start < basket.length())
+    {
+        size_t end = basket.find(',', start);
+        if (end == string::npos)
+        {
+            end = basket.length();
+        }
 
-    // Erase account from the bids table
-    auto itr_bids = _bids.find(account4sale.value);
-    _bids.erase(itr_bids);
-}
+        accounts_to_buy.push_back(name(basket.substr(start, end - start)));
+        start = end + 1;
+    }
 
-// Action: Update the sale price
-void eosnameswaps::update(name account4sale,
-                          asset saleprice,
-                          string message)
-{
+    // Check the basket size
+    check(accounts_to_buy.size() >= 1 && accounts_to_buy.size() <= MAX_BASKET, "Basket Error: A basket must contain between 1 and 20 accounts.");
 
     // ----------------------------------------------
-    // Auth checks
+    // Sale prices & fees
     // ----------------------------------------------
 
-    // Check an account with that name is listed for sale
-    auto itr_accounts = _accounts.find(account4sale.value);
+    asset totalprice = asset(0, network_symbol);
+    asset contractfee = asset(0, network_symbol);
+
+    // Seller fees are paid once per payment account
+    std::map<name, asset> sellerfees;
+
+    for (const name account_to_buy : accounts_to_buy)
+    {
+
+        // Check the account is available to buy (also rejects duplicates, which are erased below)
+        auto itr_accounts = _accounts.find(account_to_buy.value);
+        check(itr_accounts != _accounts.end(), (string("Basket Error: Account ") + account_to_buy.to_string() + string(" is not for sale.")).c_str());
+
+        // Reserved listings can only be bought by the reserving buyer
+        check_reserve(account_to_buy, from);
+
+        // Basket purchases are at the sale price (dutch auctions are priced from the current time)
+        const asset saleprice = listing_price(account_to_buy, itr_accounts->saleprice);
+
+        // Same fee model as a single purchase
+        const salequote settlement = sale_settlement(account_to_buy, saleprice, name(""));
+
+        totalprice += saleprice;
+        contractfee += settlement.contractfee;
+
+        seller_payouts(account_to_buy, settlement.paymentaccnt, settlement.sellerfee, sellerfees);
+
+        // ----------------------------------------------
+        // Update account owner
+        // ----------------------------------------------
+
+        // Remove contract@owner permissions and replace with buyer@active account and the supplied key
+        account_auth(account_to_buy, from, name("active"), name("owner"), active_key);
+
+        // Remove seller@active permissions and replace with buyer@owner account and the supplied key
+        account_auth(account_to_buy, from, name("owner"), name(""), owner_key);
+
+        // ----------------------------------------------
+        // Cleanup
+        // ----------------------------------------------
+
+        // Erase account from the listing tables
+        erase_listing(account_to_buy);
+
+        // Place sale in categories table. Contract pays for ram storage
+        catalog_sale(account_to_buy, saleprice);
+
+        // Place sale in recent sales feed. Contract pays for ram storage
+        record_sale(account_to_buy, from, saleprice);
+    }
+
+    // Any failed check above reverts the whole basket
+    check(totalprice == quantity, (string("Basket Error: You have not transferred the correct amount of ") + symbol_name + string(". Check the sale prices.")).c_str());
+
+    // ----------------------------------------------
+    // Aggregated fee transfers
+    // ----------------------------------------------
+
+    // Transfer EOS from contract to contract fees account
+    action(
+        permission_level{_self, name("active")},
+        name("eosio.token"), name("transfer"),
+        std::make_tuple(_self, feesaccount, contractfee, string("EOSNameSwaps: Basket contract fee")))
+        .send();
+
+    // Transfer EOS from contract to each seller minus the contract fees
+    for (const auto &sellerfee : sellerfees)
+    {
+        action(
+            permission_level{_self, name("active")},
+            name("eosio.token"), name("transfer"),
+            std::make_tuple(_self, sellerfee.first, sellerfee.second, string("EOSNameSwaps: Basket seller fee")))
+            .send();
+    }
+
+    // Place data in stats table. Contract pays for ram storage
+    auto itr_stats = _stats.find(0);
+    _stats.modify(itr_stats, _self, [&](auto &s) {
+        upgrade_row(s);
+        s.num_listed -= accounts_to_buy.size();
+        s.num_purchased += accounts_to_buy.size();
+        s.tot_sales += totalprice;
+        s.tot_fees += contractfee;
+    });
+
+    // Send message
+    send_message(from, string("EOSNameSwaps: You have successfully bought ") + std::to_string(accounts_to_buy.size()) + string(" accounts. Please come again."));
+}
+
+// Write a sale over the oldest slot of the recent sales feed
+void eosnameswaps::record_sale(const name account4sale, const name buyer, const asset saleprice)
+{
+
+    feedstate feed = _feedstate.get_or_default(feedstate{0});
+    const uint64_t slot = feed.num_sales % SALE_FEED_SIZE;
+
+    // The feed fills once, then every sale overwrites the oldest row in place
+    auto itr_salefeed = _salefeed.find(slot);
+    if (itr_salefeed == _salefeed.end())
+    {
+        _salefeed.emplace(_self, [&](auto &s) {
+            s.slot = slot;
+            s.seq = feed.num_sales;
+            s.account4sale = account4sale;
+            s.buyer = buyer;
+            s.saleprice = saleprice;
+            s.sold = current_time_point();
+        });
+    }
+    else
+    {
+        _salefeed.modify(itr_salefeed, same_payer, [&](auto &s) {
+            s.seq = feed.num_sales;
+            s.account4sale = account4sale;
+            s.buyer = buyer;
+            s.saleprice = saleprice;
+            s.sold = current_time_point();
+        });
+    }
+
+    feed.num_sales++;
+    _feedstate.set(feed, _self);
+}
+
+// Write bid number seq over the oldest slot of the listing's bid history
+void eosnameswaps::record_bid(const name account4sale, const uint64_t seq, const name bidder, const asset bidprice)
+{
+
+    bidhist_index bidhistory(_self, account4sale.value);
+    const uint64_t slot = seq % BID_HISTORY_SIZE;
+
+    // The newest bidder takes over the slot's ram
+    auto itr_bidhistory = bidhistory.find(slot);
+    if (itr_bidhistory == bidhistory.end())
+    {
+        bidhistory.emplace(bidder, [&](auto &s) {
+            s.slot = slot;
+            s.seq = seq;
+            s.bidder = bidder;
+            s.bidprice = bidprice;
+            s.proposed = current_time_point();
+        });
+    }
+    else
+    {
+        bidhistory.modify(itr_bidhistory, bidder, [&](auto &s) {
+            s.seq = seq;
+            s.bidder = bidder;
+            s.bidprice = bidprice;
+            s.proposed = current_time_point();
+        });
+    }
+}
+
+// Fail if another buyer holds an unexpired reservation on the listing
+void eosnameswaps::check_reserve(const name account4sale, const name buyer)
+{
+
+    auto itr_reserves = _reserves.find(account4sale.value);
+    if (itr_reserves == _reserves.end() || itr_reserves->buyer == buyer)
+    {
+        return;
+    }
+
+    check(itr_reserves->expires <= current_time_point(), "Buy Error: That account is reserved by another buyer. Try again in a few seconds.");
+}
+
+// Erase up to RESERVE_COLLECT reservations whose cooldown has ended
+void eosnameswaps::collect_reserves()
+{
+
+    const uint32_t now = current_time_point().sec_since_epoch();
+
+    auto reserves_byexpires = _reserves.get_index<name("byexpires")>();
+    auto itr_reserves = reserves_byexpires.begin();
+    for (uint8_t lp = 0; lp < RESERVE_COLLECT && itr_reserves != reserves_byexpires.end() && itr_reserves->expires.sec_since_epoch() + RESERVE_COOLDOWN * RESERVE_SEC <= now; ++lp)
+    {
+        itr_reserves = reserves_byexpires.erase(itr_reserves);
+    }
+}
+
+// Add the seller fee payouts of a listing to payouts
+void eosnameswaps::seller_payouts(const name account4sale, const name paymentaccnt, const asset sellerfee, std::map<name, asset> &payouts)
+{
+
+    std::vector<std::pair<name, int64_t>> shares;
+
+    // Listings in a shop with a split pay its payment accounts
+    auto itr_shopitems = _shopitems.find(account4sale.value);
+    if (itr_shopitems != _shopitems.end())
+    {
+        auto itr_shops = _shops.find(itr_shopitems->shopname.value);
+        if (itr_shops != _shops.end() && itr_shops->splits.has_value() && itr_shops->splits.value().size() == 3)
+        {
+            const std::vector<uint16_t> &splits = itr_shops->splits.value();
+            const name accounts[3] = {itr_shops->payment1, itr_shops->payment2, itr_shops->payment3};
+
+            // Integer shares, with the rounding remainder going to the first account with a share
+            int64_t remainder = sellerfee.amount;
+            for (int lp = 0; lp < 3; ++lp)
+            {
+                if (splits[lp] == 0)
+                {
+                    continue;
+                }
+
+                const int64_t share = static_cast<int64_t>(static_cast<__int128>(sellerfee.amount) * splits[lp] / 10000);
+                shares.emplace_back(accounts[lp], share);
+                remainder -= share;
+            }
+
+            if (!shares.empty())
+            {
+                shares[0].second += remainder;
+            }
+        }
+    }
+
+    // Otherwise the listing's payment account gets it all
+    if (shares.empty())
+    {
+        shares.emplace_back(paymentaccnt, sellerfee.amount);
+    }
+
+    // One transfer per account however many listings or shares it is paid for
+    for (const auto &share : shares)
+    {
+        if (share.second <= 0)
+        {
+            continue;
+        }
+
+        auto itr_payouts = payouts.find(share.first);
+        if (itr_payouts == payouts.end())
+        {
+            payouts[share.first] = asset(share.second, sellerfee.symbol);
+        }
+        else
+        {
+            itr_payouts->second.amount += share.second;
+        }
+    }
+}
+
+// Price a buyer pays for a listing: the bid price for the accepted bidder, otherwise the listing price
+asset eosnameswaps::buyer_price(const name account4sale, const asset listprice, const name buyer)
+{
+
+    auto itr_bids = _bids.find(account4sale.value);
+    if (itr_bids != _bids.end() && itr_bids->bidder == buyer && itr_bids->bidaccepted == BID_ACCEPTED)
+    {
+        return itr_bids->bidprice;
+    }
+
+    return listprice;
+}
+
+// Split the sale price between the seller, contract and referrer
+salequote eosnameswaps::sale_settlement(const name account_to_buy, const asset saleprice, const name referrer)
+{
+
+    auto itr_accounts = _accounts.find(account_to_buy.value);
+
+    salequote settlement;
+    settlement.account4sale = account_to_buy;
+    settlement.saleprice = saleprice;
+    settlement.paymentaccnt = itr_accounts->paymentaccnt;
+    settlement.ref_account = name("");
+    settlement.referrerfee = asset(0, network_symbol);
+
+    // Fee amounts
+    settlement.contractfee = asset(static_cast<int64_t>(static_cast<__int128>(saleprice.amount) * contract_fee_bp / 10000), network_symbol);
+    settlement.sellerfee = asset(saleprice.amount - settlement.contractfee.amount, network_symbol);
+
+    // Look up the referrer account
+    if (referrer != name(""))
+    {
+        auto itr_referrer = _referrer.find(referrer.value);
+        if (itr_referrer != _referrer.end())
+        {
+            settlement.ref_account = itr_referrer->ref_account;
+            settlement.referrerfee.amount = settlement.contractfee.amount * referrer_fee_bp / 10000;
+            settlement.contractfee.amount -= settlement.referrerfee.amount;
+        }
+    }
+
+    // Transfer memo
+    settlement.memo = string("sp:") + account_to_buy.to_string() + string(",<owner_key>,<active_key>");
+    if (settlement.ref_account != name(""))
+    {
+        settlement.memo += string(",") + referrer.to_string();
+    }
+
+    return settlement;
+}
+
+// Action: Quote the settlement of a listed account
+salequote eosnameswaps::quote(name account4sale,
+                              name buyer,
+                              name referrer)
+{
+
+    // ----------------------------------------------
+    // Valid transaction checks
+    // ----------------------------------------------
+
+    // Check the account is available to buy
+    auto itr_accounts = _accounts.find(account4sale.value);
+    check(itr_accounts != _accounts.end(), (string("Quote Error: Account ") + account4sale.to_string() + string(" is not for sale.")).c_str());
+
+    // ----------------------------------------------
+    // Sale/Bid price
+    // ----------------------------------------------
+
+    // The accepted bidder can buy at the bid price (same rule as settlement)
+    const asset saleprice = buyer_price(account4sale, listing_price(account4sale, itr_accounts->saleprice), buyer);
+
+    // No table writes or inline actions, so this can run as a read-only transaction
+    return sale_settlement(account4sale, saleprice, referrer);
+}
+
+// Action: Remove a listed account from sale
+void eosnameswaps::cancel(name account4sale,
+                          string owner_key_str,
+                          string active_key_str)
+{
+
+    // ----------------------------------------------
+    // Auth checks
+    // ----------------------------------------------
+
+    // Check an account with that name is listed for sale
+    auto itr_accounts = _accounts.find(account4sale.value);
+    check(itr_accounts != _accounts.end(), "Cancel Error: That account name is not listed for sale");
+
+    // Only the payment account can cancel the sale (the contract has the owner key)
+    check(has_auth(itr_accounts->paymentaccnt) || has_auth(_self), "Cancel Error: Only the payment account can cancel the sale.");
+
+    const name paymentaccnt = itr_accounts->paymentaccnt;
+
+    // ----------------------------------------------
+    // Update account owners
+    // ----------------------------------------------
+
+    // Change auth from contract@active to submitted active key
+    account_auth(account4sale, paymentaccnt, name("active"), name("owner"), active_key_str);
+
+    // Change auth from contract@owner to submitted owner key
+    account_auth(account4sale, paymentaccnt, name("owner"), name(""), owner_key_str);
+
+    // ----------------------------------------------
+    // Cleanup
+    // ----------------------------------------------
+
+    // Erase account from the listing tables
+    erase_listing(account4sale);
+
+    // Place data in stats table. Contract pays for ram storage
+    auto itr_stats = _stats.find(0);
+    _stats.modify(itr_stats, _self, [&](auto &s) {
+        upgrade_row(s);
+        s.num_listed--;
+    });
+
+    // Send message
+    send_message(paymentaccnt, string("EOSNameSwaps: You have successfully cancelled the sale of the account ") + name{account4sale}.to_string() + string(". Please come again."));
+}
+
+// Action: Remove a listed account from sale
+void eosnameswaps::remove(name account4sale)
+{
+
+    // ----------------------------------------------
+    // Auth checks
+    // ----------------------------------------------
+
+    // Check an account with that name is listed for sale
+    auto itr_accounts = _accounts.find(account4sale.value);
+    check(itr_accounts != _accounts.end(), "Cancel Error: That account name is not listed for sale");
+
+    // Only the contract account can remove the sale (the contract has the owner key)
+    check(has_auth(_self), "Cancel Error: Only the contract account can remove the sale.");
+
+    // Cleanup
+    // ----------------------------------------------
+
+    // Erase account from the listing tables
+    erase_listing(account4sale);
+}
+
+// Action: Update the sale price
+void eosnameswaps::update(name account4sale,
+                          asset saleprice,
+                          string message)
+{
+
+    // ----------------------------------------------
+    // Auth checks
+    // ----------------------------------------------
+
+    // Check an account with that name is listed for sale
+    auto itr_accounts = _accounts.find(account4sale.value);
     check(itr_accounts != _accounts.end(), "Update Error: That account name is not listed for sale");
 
     // Only the payment account can update the sale price
@@ -652,61 +1212,295 @@ void eosnameswaps::update(name account4sale,
 
     // Place data in accounts table. Payment account pays for ram storage
     _accounts.modify(itr_accounts, itr_accounts->paymentaccnt, [&](auto &s) {
+        upgrade_row(s);
         s.saleprice = saleprice;
     });
 
     // Place data in extras table. Payment account pays for ram storage
     auto itr_extras = _extras.find(account4sale.value);
     _extras.modify(itr_extras, itr_accounts->paymentaccnt, [&](auto &s) {
+        upgrade_row(s);
         s.message = message;
     });
 
+    // Place data in catalog table
+    catalog_update(account4sale, saleprice);
+
+    // A fixed price replaces any dutch auction
+    auto itr_dutch = _dutch.find(account4sale.value);
+    if (itr_dutch != _dutch.end())
+    {
+        _dutch.erase(itr_dutch);
+    }
+
+    stamp_change(account4sale, _self);
+
     // Send message
     send_message(itr_accounts->paymentaccnt, string("EOSNameSwaps: You have successfully updated the sale of the account ") + name{account4sale}.to_string());
 }
 
-// Action: Increment votes
-void eosnameswaps::vote(name account4sale,
-                        name voter)
+// Action: Set a declining sale price
+void eosnameswaps::dutch(name account4sale,
+                         asset startprice,
+                         asset endprice,
+                         uint32_t duration)
 {
 
     // ----------------------------------------------
     // Auth checks
     // ----------------------------------------------
 
-    // Confirm the voter is who they say they are
-    check(has_auth(voter), "Vote Error: You are not who you say you are. Check permissions.");
+    // Check an account with that name is listed for sale
+    auto itr_accounts = _accounts.find(account4sale.value);
+    check(itr_accounts != _accounts.end(), "Dutch Error: That account name is not listed for sale");
+
+    // Only the payment account can set a dutch auction
+    check(has_auth(itr_accounts->paymentaccnt), "Dutch Error: Only the payment account can update a sale.");
 
     // ----------------------------------------------
     // Valid transaction checks
     // ----------------------------------------------
 
-    // Check an account with that name is listed for sale
-    auto itr_extras = _extras.find(account4sale.value);
-    check(itr_extras != _extras.end(), "Vote Error: That account name is not listed for sale.");
+    // Check the prices are valid
+    check(startprice.symbol == network_symbol && endprice.symbol == network_symbol, (string("Dutch Error: Prices must be in ") + symbol_name + string(". Ex: 10.0000 ") + symbol_name + string(".")).c_str());
+    check(startprice.is_valid() && endprice.is_valid(), "Dutch Error: Price is not valid.");
+    check(endprice >= asset(10000, network_symbol), (string("Dutch Error: End price must be at least 1 ") + symbol_name + string(". Ex: 1.0000 ") + symbol_name + string(".")).c_str());
+    check(startprice > endprice, "Dutch Error: The start price must be higher than the end price.");
 
-    // Can only vote once in a row
-    check(voter != itr_extras->last_voter, "Vote Error: You have already voted for this account!");
+    // Check the duration is between 1 hour and 90 days
+    check(duration >= 3600 && duration <= 90 * 86400, "Dutch Error: The duration must be between 1 hour and 90 days.");
 
     // ----------------------------------------------
-    // Update table
+    // Update tables
     // ----------------------------------------------
 
-    // Place data in extras table. Voter pays for ram storage
-    _extras.modify(itr_extras, voter, [&](auto &s) {
-        s.numberofvotes++;
-        s.last_voter = voter;
+    // The auction starts at the start price
+    _accounts.modify(itr_accounts, itr_accounts->paymentaccnt, [&](auto &s) {
+        upgrade_row(s);
+        s.saleprice = startprice;
     });
-}
 
-// Action: Register Referrer
-void eosnameswaps::regref(eosio::name ref_name,
-                          eosio::name ref_account)
-{
+    catalog_update(account4sale, startprice);
 
-    // ----------------------------------------------
-    // Auth checks
-    // ----------------------------------------------
+    // Place data in dutch table. Payment account pays for ram storage
+    auto itr_dutch = _dutch.find(account4sale.value);
+    if (itr_dutch == _dutch.end())
+    {
+        _dutch.emplace(itr_accounts->paymentaccnt, [&](auto &s) {
+            s.account4sale = account4sale;
+            s.startprice = startprice;
+            s.endprice = endprice;
+            s.starttime = current_time_point();
+            s.duration = duration;
+            s.decaybucket = 0;
+        });
+    }
+    else
+    {
+        _dutch.modify(itr_dutch, itr_accounts->paymentaccnt, [&](auto &s) {
+            s.startprice = startprice;
+            s.endprice = endprice;
+            s.starttime = current_time_point();
+            s.duration = duration;
+            s.decaybucket = 0;
+        });
+    }
+
+    stamp_change(account4sale, _self);
+
+    // Send message
+    send_message(itr_accounts->paymentaccnt, string("EOSNameSwaps: You have successfully started a dutch auction for the account ") + name{account4sale}.to_string());
+}
+
+// Action: Make accounts paid from the account creation credit
+void eosnameswaps::bulkmake(name from,
+                            std::vector<newaccountreq> accounts)
+{
+
+    // ----------------------------------------------
+    // Auth checks
+    // ----------------------------------------------
+
+    // Only the owner of the credit can spend it
+    require_auth(from);
+
+    // ----------------------------------------------
+    // Valid transaction checks
+    // ----------------------------------------------
+
+    check(accounts.size() >= 1 && accounts.size() <= MAX_BULK, "Bulk Make Error: A request must contain between 1 and 50 accounts.");
+
+    // Check the credit covers every account
+    auto itr_credits = _credits.find(from.value);
+    check(itr_credits != _credits.end(), "Bulk Make Error: You have no account creation credit.");
+
+    // The RAM market is read once for the whole request
+    const asset totalfee = newaccount_price() * accounts.size();
+    const uint32_t ram_bytes = _config.get_or_default(configtable{newaccountbytes, 0}).newaccount_bytes;
+    check(itr_credits->balance >= totalfee, "Bulk Make Error: Not enough account creation credit.");
+
+    // Validate every key before sending any action
+    std::vector<std::pair<authority, authority>> auths;
+    auths.reserve(accounts.size());
+    for (const auto &request : accounts)
+    {
+        auths.emplace_back(keystring_authority(request.owner_key), keystring_authority(request.active_key));
+    }
+
+    // ----------------------------------------------
+
+    // Create accounts
+    for (size_t lp = 0; lp < accounts.size(); ++lp)
+    {
+        create_account(accounts[lp].account_name, auths[lp].first, auths[lp].second, ram_bytes);
+    }
+
+    // Spend the credit. Contract pays for ram storage
+    if (itr_credits->balance == totalfee)
+    {
+        _credits.erase(itr_credits);
+    }
+    else
+    {
+        _credits.modify(itr_credits, _self, [&](auto &s) {
+            s.balance -= totalfee;
+        });
+    }
+
+    // Update stats table
+    _stats.modify(_stats.find(5), _self, [&](auto &s) {
+        upgrade_row(s);
+        s.num_purchased += accounts.size();
+        s.tot_sales += totalfee;
+    });
+}
+
+// Action: Withdraw unused account creation credit
+void eosnameswaps::withdraw(name from,
+                            asset quantity)
+{
+
+    // ----------------------------------------------
+    // Auth checks
+    // ----------------------------------------------
+
+    // Only the owner of the credit can withdraw it
+    require_auth(from);
+
+    // ----------------------------------------------
+    // Valid transaction checks
+    // ----------------------------------------------
+
+    auto itr_credits = _credits.find(from.value);
+    check(itr_credits != _credits.end(), "Withdraw Error: You have no account creation credit.");
+
+    check(quantity.symbol == network_symbol && quantity.amount > 0, "Withdraw Error: Quantity is not valid.");
+    check(quantity <= itr_credits->balance, "Withdraw Error: Not enough account creation credit.");
+
+    // ----------------------------------------------
+
+    // Update credits table. Contract pays for ram storage
+    if (itr_credits->balance == quantity)
+    {
+        _credits.erase(itr_credits);
+    }
+    else
+    {
+        _credits.modify(itr_credits, _self, [&](auto &s) {
+            s.balance -= quantity;
+        });
+    }
+
+    // Return the credit
+    action(
+        permission_level{_self, name("active")},
+        name("eosio.token"), name("transfer"),
+        std::make_tuple(_self, from, quantity, string("EOSNameSwaps: Account creation credit withdrawal")))
+        .send();
+}
+
+// Action: Cancel a wanted offer
+void eosnameswaps::cancelwant(uint64_t id)
+{
+
+    // ----------------------------------------------
+    // Auth checks
+    // ----------------------------------------------
+
+    // Check the offer exists
+    auto itr_wanted = _wanted.find(id);
+    check(itr_wanted != _wanted.end(), "Wanted Error: That offer does not exist.");
+
+    // Only the buyer can cancel the offer
+    check(has_auth(itr_wanted->buyer) || has_auth(_self), "Wanted Error: Only the buyer can cancel the offer.");
+
+    // ----------------------------------------------
+
+    // Refund the escrowed offer
+    action(
+        permission_level{_self, name("active")},
+        name("eosio.token"), name("transfer"),
+        std::make_tuple(_self, itr_wanted->buyer, itr_wanted->price, string("EOSNameSwaps: Wanted offer cancelled: ") + itr_wanted->account4sale.to_string()))
+        .send();
+
+    // Erase the offer from the wanted table
+    _wanted.erase(itr_wanted);
+}
+
+// Action: Increment votes
+void eosnameswaps::vote(name account4sale,
+                        name voter)
+{
+
+    // ----------------------------------------------
+    // Auth checks
+    // ----------------------------------------------
+
+    // Confirm the voter is who they say they are
+    check(has_auth(voter), "Vote Error: You are not who you say you are. Check permissions.");
+
+    // Limit how often the voter can vote
+    throttle(name("vote"), voter);
+
+    // ----------------------------------------------
+    // Valid transaction checks
+    // ----------------------------------------------
+
+    // Check an account with that name is listed for sale
+    auto itr_extras = _extras.find(account4sale.value);
+    check(itr_extras != _extras.end(), "Vote Error: That account name is not listed for sale.");
+
+    // Can only vote once in a row
+    check(voter != itr_extras->last_voter, "Vote Error: You have already voted for this account!");
+
+    // ----------------------------------------------
+    // Update table
+    // ----------------------------------------------
+
+    // Place data in extras table. Voter pays for ram storage
+    _extras.modify(itr_extras, voter, [&](auto &s) {
+        upgrade_row(s);
+        s.numberofvotes++;
+        s.last_voter = voter;
+    });
+
+    // Stored dutch auction prices follow any activity on the listing
+    dutch_refresh(account4sale);
+
+    stamp_change(account4sale, _self);
+
+    // Place data in trending table. Contract pays for ram storage
+    trend_add(account4sale, TREND_VOTE);
+}
+
+// Action: Register Referrer
+void eosnameswaps::regref(eosio::name ref_name,
+                          eosio::name ref_account)
+{
+
+    // ----------------------------------------------
+    // Auth checks
+    // ----------------------------------------------
 
     check(has_auth(_self), "Referrer Error: Only the contract account can register referrers.");
 
@@ -721,255 +1515,1165 @@ void eosnameswaps::regref(eosio::name ref_name,
     // Update table
     // ----------------------------------------------
 
-    // Place data in referrer table. Contract pays for ram storage
-    _referrer.emplace(_self, [&](auto &s) {
-        s.ref_name = ref_name;
-        s.ref_account = ref_account;
-    });
+    auto itr_referrer = _referrer.find(ref_name.value);
+
+    // Register new referrer
+    if (itr_referrer == _referrer.end())
+    {
+
+        // Place data in referrer table. Contract pays for ram storage
+        _referrer.emplace(_self, [&](auto &s) {
+            s.ref_name = ref_name;
+            s.ref_account = ref_account;
+        });
+    }
+    else // Change the referrer's fee account
+    {
+
+        // Place data in referrer table. Contract pays for ram storage
+        _referrer.modify(itr_referrer, _self, [&](auto &s) {
+            s.ref_account = ref_account;
+        });
+    }
+}
+
+// Action: Register Shop
+void eosnameswaps::regshop(name shopname,
+                           string title,
+                           string description,
+                           name payment1,
+                           name payment2,
+                           name payment3)
+{
+
+    // ----------------------------------------------
+    // Auth checks
+    // ----------------------------------------------
+
+    check(has_auth(_self), "Referrer Error: Only the contract account can register shops.");
+
+    // ----------------------------------------------
+    // Update table
+    // ----------------------------------------------
+
+    auto itr_shops = _shops.find(shopname.value);
+
+    // Create new shop
+    if (itr_shops == _shops.end())
+    {
+
+        // Place data in shoptable. Contract pays for ram storage
+        _shops.emplace(_self, [&](auto &s) {
+            s.shopname = shopname;
+            s.title = title;
+            s.description = description;
+            s.payment1 = payment1;
+            s.payment2 = payment2;
+            s.payment3 = payment3;
+        });
+    }
+    else // Modify shop
+    {
+
+        // Place data in shoptable. Contract pays for ram storage
+        _shops.modify(itr_shops, _self, [&](auto &s) {
+            s.shopname = shopname;
+            s.title = title;
+            s.description = description;
+            s.payment1 = payment1;
+            s.payment2 = payment2;
+            s.payment3 = payment3;
+        });
+    }
+}
+
+// Action: Set the seller fee split of a shop
+void eosnameswaps::setsplits(name shopname,
+                             uint16_t split1,
+                             uint16_t split2,
+                             uint16_t split3)
+{
+
+    // ----------------------------------------------
+    // Auth checks
+    // ----------------------------------------------
+
+    check(has_auth(_self), "Shop Error: Only the contract account can set shop splits.");
+
+    // ----------------------------------------------
+    // Valid transaction checks
+    // ----------------------------------------------
+
+    auto itr_shops = _shops.find(shopname.value);
+    check(itr_shops != _shops.end(), "Shop Error: That shop is not registered.");
+
+    // A zero total clears the split
+    check(uint32_t(split1) + split2 + split3 == 10000 || uint32_t(split1) + split2 + split3 == 0, "Shop Error: The splits must add up to 10000 basis points.");
+
+    // Every share must have an account to go to
+    check(split1 == 0 || is_account(itr_shops->payment1), "Shop Error: Payment account 1 does not exist.");
+    check(split2 == 0 || is_account(itr_shops->payment2), "Shop Error: Payment account 2 does not exist.");
+    check(split3 == 0 || is_account(itr_shops->payment3), "Shop Error: Payment account 3 does not exist.");
+
+    // ----------------------------------------------
+    // Update table
+    // ----------------------------------------------
+
+    // Place data in shoptable. Contract pays for ram storage
+    _shops.modify(itr_shops, _self, [&](auto &s) {
+        if (split1 + split2 + split3 == 0)
+        {
+            s.splits = std::vector<uint16_t>();
+        }
+        else
+        {
+            s.splits = std::vector<uint16_t>{split1, split2, split3};
+        }
+    });
+}
+
+// Action: Put a listing in a shop
+void eosnameswaps::setshop(name account4sale,
+                           name shopname)
+{
+
+    // ----------------------------------------------
+    // Auth checks
+    // ----------------------------------------------
+
+    // Check an account with that name is listed for sale
+    auto itr_accounts = _accounts.find(account4sale.value);
+    check(itr_accounts != _accounts.end(), "Shop Error: That account name is not listed for sale.");
+
+    // Only the payment account can choose the shop
+    check(has_auth(itr_accounts->paymentaccnt), "Shop Error: Only the payment account can put a sale in a shop.");
+
+    // ----------------------------------------------
+    // Valid transaction checks
+    // ----------------------------------------------
+
+    check(shopname == name("") || _shops.find(shopname.value) != _shops.end(), "Shop Error: That shop is not registered.");
+
+    // ----------------------------------------------
+    // Update table
+    // ----------------------------------------------
+
+    auto itr_shopitems = _shopitems.find(account4sale.value);
+
+    if (shopname == name(""))
+    {
+        if (itr_shopitems != _shopitems.end())
+        {
+            _shopitems.erase(itr_shopitems);
+        }
+    }
+    else if (itr_shopitems == _shopitems.end())
+    {
+
+        // Place data in shop items table. Payment account pays for ram storage
+        _shopitems.emplace(itr_accounts->paymentaccnt, [&](auto &s) {
+            s.account4sale = account4sale;
+            s.shopname = shopname;
+        });
+    }
+    else
+    {
+        _shopitems.modify(itr_shopitems, itr_accounts->paymentaccnt, [&](auto &s) {
+            s.shopname = shopname;
+        });
+    }
+}
+
+// Action: Propose a bid for an account
+void eosnameswaps::proposebid(name account4sale,
+                              asset bidprice,
+                              name bidder)
+{
+
+    // ----------------------------------------------
+    // Auth checks
+    // ----------------------------------------------
+
+    // Confirm the bidder is who they say they are
+    check(has_auth(bidder), "Propose Bid Error: You are not who you say you are. Check permissions.");
+
+    // Limit how often the bidder can bid
+    throttle(name("proposebid"), bidder);
+
+    // ----------------------------------------------
+    // Valid transaction checks
+    // ----------------------------------------------
+
+    // Check an account with that name is listed for sale
+    auto itr_bids = _bids.find(account4sale.value);
+    check(itr_bids != _bids.end(), "Propose Bid Error: That account name is not listed for sale");
+
+    // Check the transfer is valid
+    check(bidprice.symbol == network_symbol, (string("Propose Bid Error: Bid price must be in ") + symbol_name + string(". Ex: 10.0000 ") + symbol_name + string(".")).c_str());
+    check(bidprice.is_valid(), "Propose Bid Error: Bid price is not valid.");
+    check(bidprice >= asset(10000, network_symbol), (string("Propose Bid Error: The minimum bid price is 1.0000 ") + symbol_name + string(".")).c_str());
+
+    // Only accept new bids if they are higher
+    check(bidprice > itr_bids->bidprice, "Propose Bid Error: You must bid higher than the last bidder.");
+
+    // Only accept new bids if they are lower than the sale price
+    auto itr_accounts = _accounts.find(account4sale.value);
+    check(bidprice <= listing_price(account4sale, itr_accounts->saleprice), "Propose Bid Error: You must bid lower than the sale price.");
+
+    // Bring a dutch auction's stored price up to date
+    dutch_refresh(account4sale);
+
+    // ----------------------------------------------
+    // Update table
+    // ----------------------------------------------
+
+    // Bid number on the listing, for the bid history
+    const uint64_t bid_seq = itr_bids->numbids.value_or(0);
+
+    // Place data in bids table. Bidder pays for ram storage
+    _bids.modify(itr_bids, bidder, [&](auto &s) {
+        upgrade_row(s);
+        s.bidaccepted = 1;
+        s.bidprice = bidprice;
+        s.bidder = bidder;
+        s.numbids = bid_seq + 1;
+    });
+
+    // Place data in bid history. Bidder pays for ram storage
+    record_bid(account4sale, bid_seq, bidder, bidprice);
+
+    stamp_change(account4sale, _self);
+
+    // Place data in trending table. Contract pays for ram storage
+    trend_add(account4sale, TREND_BID);
+
+    // Send message
+    send_message(itr_accounts->paymentaccnt, string("EOSNameSwaps: Your account ") + name{account4sale}.to_string() + string(" has received a bid. If you choose to accept it, the bidder can purchase the account at the lower price. Others can still bid higher or pay the full sale price until then."));
+}
+
+// Action: Accept or decline a bid for an account
+void eosnameswaps::decidebid(name account4sale,
+                             bool accept)
+{
+
+    // ----------------------------------------------
+    // Auth checks
+    // ----------------------------------------------
+
+    // Check an account with that name is listed for sale
+    auto itr_accounts = _accounts.find(account4sale.value);
+    check(itr_accounts != _accounts.end(), "Decide Bid Error: That account name is not listed for sale.");
+
+    // Only the payment account can accept bids
+    check(has_auth(itr_accounts->paymentaccnt), "Decide Bid Error: Only the payment account can decide on bids.");
+
+    // Stored dutch auction prices follow any activity on the listing
+    dutch_refresh(account4sale);
+
+    // ----------------------------------------------
+    // Valid transaction checks
+    // ----------------------------------------------
+
+    auto itr_bids = _bids.find(account4sale.value);
+
+    // Check there is a bid to accept or reject
+    check(itr_bids->bidprice != asset(0, network_symbol), "Decide Bid Error: There are no bids to accept or reject.");
+
+    // ----------------------------------------------
+    // Update table
+    // ----------------------------------------------
+
+    // Place data in bids table. Bidder pays for ram storage
+    if (accept == true)
+    {
+
+        // Bid accepted
+        _bids.modify(itr_bids, itr_accounts->paymentaccnt, [&](auto &s) {
+            upgrade_row(s);
+            s.bidaccepted = 2;
+        });
+
+        stamp_change(account4sale, _self);
+
+        // Send message
+        send_message(itr_bids->bidder, string("EOSNameSwaps: Your bid for ") + name{account4sale}.to_string() + string(" has been accepted. Account ") + name{itr_bids->bidder}.to_string() + string(" can buy it for the bid price. Be quick, as others can still outbid you or pay the full sale price."));
+    }
+    else
+    {
+
+        // Bid rejected
+        _bids.modify(itr_bids, itr_accounts->paymentaccnt, [&](auto &s) {
+            upgrade_row(s);
+            s.bidaccepted = 0;
+        });
+
+        stamp_change(account4sale, _self);
+
+        // Send message
+        send_message(itr_bids->bidder, string("EOSNameSwaps: Your bid for ") + name{account4sale}.to_string() + string(" has been rejected. Increase your bid offer"));
+    }
+}
+
+// Null Action
+void eosnameswaps::null()
+{
+
+    // ----------------------------------------------
+    // Auth checks
+    // ----------------------------------------------
+
+    // Only the contract can send a message
+    check(has_auth(_self), "Message Error: Only the contract can call the null action.");
+
+    // ----------------------------------------------
+}
+
+// Action: Hold a listing for a buyer for a few seconds
+void eosnameswaps::reserve(name account4sale,
+                           name buyer)
+{
+
+    // ----------------------------------------------
+    // Auth checks
+    // ----------------------------------------------
+
+    // Only the buyer can reserve for themselves
+    require_auth(buyer);
+
+    // Reservations are rate limited per buyer (see setlimit)
+    throttle(name("reserve"), buyer);
+
+    // ----------------------------------------------
+    // Valid transaction checks
+    // ----------------------------------------------
+
+    // Check an account with that name is listed for sale
+    auto itr_accounts = _accounts.find(account4sale.value);
+    check(itr_accounts != _accounts.end(), "Reserve Error: That account name is not listed for sale.");
+
+    check(buyer != itr_accounts->paymentaccnt && buyer != account4sale, "Reserve Error: You cannot reserve your own listing.");
+
+    // Stored dutch auction prices follow any activity on the listing
+    dutch_refresh(account4sale);
+
+    // Reservations from earlier drops are collected here rather than by a cleanup action
+    collect_reserves();
+
+    const time_point_sec now = current_time_point();
+    auto itr_reserves = _reserves.find(account4sale.value);
+    if (itr_reserves != _reserves.end() && itr_reserves->expires > now)
+    {
+        check(itr_reserves->buyer != buyer, "Reserve Error: You already hold the reservation.");
+        check(false, "Reserve Error: That account is reserved by another buyer.");
+    }
+
+    // The listing stays open to every buyer for the cooldown after a reservation expires,
+    // so the previous holder (or another account taking its turn) cannot renew it back to back
+    check(itr_reserves == _reserves.end() || itr_reserves->expires + RESERVE_COOLDOWN * RESERVE_SEC <= now, "Reserve Error: That account was reserved recently. Try again later.");
+
+    // ----------------------------------------------
+    // Update table
+    // ----------------------------------------------
+
+    // Place data in reservations table. Buyer pays for ram storage
+    if (itr_reserves == _reserves.end())
+    {
+        _reserves.emplace(buyer, [&](auto &s) {
+            s.account4sale = account4sale;
+            s.buyer = buyer;
+            s.expires = now + RESERVE_SEC;
+        });
+    }
+    else
+    {
+        _reserves.modify(itr_reserves, buyer, [&](auto &s) {
+            s.buyer = buyer;
+            s.expires = now + RESERVE_SEC;
+        });
+    }
+}
+
+// Message Action
+void eosnameswaps::message(name receiver,
+                           string message)
+{
+
+    // ----------------------------------------------
+    // Auth checks
+    // ----------------------------------------------
+
+    // Only the contract can send a message
+    check(has_auth(_self), "Message Error: Only the contract can send messages.");
+
+    // ----------------------------------------------
+
+    // Notify the specified account
+    require_recipient(receiver);
+}
+
+// Action: Perform admin tasks
+void eosnameswaps::screener(name account4sale,
+                            uint8_t option)
+{
+
+    // ----------------------------------------------
+    // Auth checks
+    // ----------------------------------------------
+
+    // Only the contract account can perform screening
+    require_auth(_self);
+
+    // ----------------------------------------------
+    // Set the screening status of an account listed for sale
+    // ----------------------------------------------
+
+    screen_listing(account4sale, option);
+}
+
+// Action: Perform screening of many accounts
+void eosnameswaps::screenbatch(std::vector<screenopt> screenings)
+{
+
+    // ----------------------------------------------
+    // Auth checks
+    // ----------------------------------------------
+
+    // Only the contract account can perform screening
+    require_auth(_self);
+
+    // ----------------------------------------------
+    // Valid transaction checks
+    // ----------------------------------------------
+
+    check(screenings.size() >= 1 && screenings.size() <= MAX_SCREENBATCH, "Admin Error: A screening batch must contain between 1 and 100 accounts.");
+
+    // ----------------------------------------------
+    // Set the screening status of each account
+    // ----------------------------------------------
+
+    for (const auto &screening : screenings)
+    {
+        screen_listing(screening.account4sale, screening.option);
+    }
+}
+
+// Init the stats table
+void eosnameswaps::initstats()
+{
+
+    // ----------------------------------------------
+    // Auth checks
+    // ----------------------------------------------
+
+    // Only the contract account can init the stats table
+    require_auth(_self);
+
+    // ----------------------------------------------
+
+    // Init stats table
+    auto itr_stats = _stats.find(0);
+    if (itr_stats == _stats.end())
+    {
+
+        for (int index = 0; index <= 5; index++)
+        {
+            _stats.emplace(_self, [&](auto &s) {
+                upgrade_row(s);
+                s.index = index;
+                s.num_listed = 0;
+                s.num_purchased = 0;
+                s.tot_sales = asset(0, network_symbol);
+                s.tot_fees = asset(0, network_symbol);
+            });
+        }
+    }
+}
+
+// Take a call from the account's token bucket for the action
+void eosnameswaps::throttle(const name action, const name account)
+{
+
+    // Actions without a configured limit are not rate limited
+    if (!_config.exists())
+    {
+        return;
+    }
+
+    const configtable config = _config.get();
+    if (!config.ratelimits.has_value())
+    {
+        return;
+    }
+
+    const std::vector<ratelimit> &limits = config.ratelimits.value();
+    auto itr_limit = std::find_if(limits.begin(), limits.end(), [&](const ratelimit &l) { return l.action == action; });
+    if (itr_limit == limits.end() || itr_limit->capacity == 0)
+    {
+        return;
+    }
+
+    const uint32_t now = current_time_point().sec_since_epoch();
+
+    throttle_index throttles(_self, action.value);
+
+    // Idle buckets from earlier callers are collected here rather than by a cleanup action
+    collect_throttles(throttles);
+
+    auto itr_throttle = throttles.find(account.value);
+
+    // First call starts with a full bucket. Caller pays for ram storage
+    if (itr_throttle == throttles.end())
+    {
+        throttles.emplace(account, [&](auto &s) {
+            s.account = account;
+            s.refilled = time_point_sec(now);
+            s.tokens = itr_limit->capacity - 1;
+            s.full = time_point_sec(now + itr_limit->refill_sec);
+        });
+        return;
+    }
+
+    // Add the whole calls refilled since the last refill, up to the capacity
+    const uint32_t refills = (now - itr_throttle->refilled.sec_since_epoch()) / itr_limit->refill_sec;
+    uint8_t tokens = itr_throttle->tokens;
+    time_point_sec refilled = itr_throttle->refilled;
+    if (tokens >= itr_limit->capacity || refills >= uint32_t(itr_limit->capacity - tokens))
+    {
+        tokens = itr_limit->capacity;
+        refilled = time_point_sec(now);
+    }
+    else
+    {
+        tokens += refills;
+        refilled = refilled + refills * itr_limit->refill_sec;
+    }
+
+    check(tokens > 0, (string("Rate Limit Error: Too many ") + action.to_string() + string(" actions. Try again later.")).c_str());
+
+    throttles.modify(itr_throttle, account, [&](auto &s) {
+        s.refilled = refilled;
+        s.tokens = tokens - 1;
+        s.full = refilled + (itr_limit->capacity - tokens + 1) * itr_limit->refill_sec;
+    });
+}
+
+// Erase up to THROTTLE_COLLECT buckets that have refilled completely
+void eosnameswaps::collect_throttles(throttle_index &throttles)
+{
+
+    const uint32_t now = current_time_point().sec_since_epoch();
+
+    auto throttles_byfull = throttles.get_index<name("byfull")>();
+    auto itr_throttle = throttles_byfull.begin();
+    for (uint8_t lp = 0; lp < THROTTLE_COLLECT && itr_throttle != throttles_byfull.end() && itr_throttle->full.sec_since_epoch() <= now; ++lp)
+    {
+        itr_throttle = throttles_byfull.erase(itr_throttle);
+    }
+}
+
+// Erase a listing from the accounts, extras, bids, catalog and dutch tables
+void eosnameswaps::erase_listing(const name account4sale)
+{
+
+    // Erase account from the accounts table
+    auto itr_accounts = _accounts.find(account4sale.value);
+    _accounts.erase(itr_accounts);
+
+    // Erase account from the extras table
+    auto itr_extras = _extras.find(account4sale.value);
+    _extras.erase(itr_extras);
+
+    // Erase account from the bids table and its bid history (only the slots written so far exist)
+    auto itr_bids = _bids.find(account4sale.value);
+    bidhist_index bidhistory(_self, account4sale.value);
+    for (uint64_t slot = 0; slot < std::min(itr_bids->numbids.value_or(0), BID_HISTORY_SIZE); ++slot)
+    {
+        bidhistory.erase(bidhistory.find(slot));
+    }
+    _bids.erase(itr_bids);
+
+    // Erase account from the catalog table
+    catalog_erase(account4sale);
+
+    // Erase account from the dutch table
+    auto itr_dutch = _dutch.find(account4sale.value);
+    if (itr_dutch != _dutch.end())
+    {
+        _dutch.erase(itr_dutch);
+    }
+
+    // Erase account from the screening queue
+    auto itr_screening = _screening.find(account4sale.value);
+    if (itr_screening != _screening.end())
+    {
+        _screening.erase(itr_screening);
+    }
+
+    // Erase account from the reservations table
+    auto itr_reserves = _reserves.find(account4sale.value);
+    if (itr_reserves != _reserves.end())
+    {
+        _reserves.erase(itr_reserves);
+    }
+
+    // Erase account from the shop items table
+    auto itr_shopitems = _shopitems.find(account4sale.value);
+    if (itr_shopitems != _shopitems.end())
+    {
+        _shopitems.erase(itr_shopitems);
+    }
+
+    // Erase account from the trending table
+    auto itr_trending = _trending.find(account4sale.value);
+    if (itr_trending != _trending.end())
+    {
+        _trending.erase(itr_trending);
+    }
+
+    // Leave a tombstone for mirrors
+    tombstone_change(account4sale);
+}
+
+// Add activity to a listing's trending score
+void eosnameswaps::trend_add(const name account4sale, const double weight)
+{
+
+    // The weight decays from now, which is the same as a grown weight decaying from the epoch.
+    // Working in log2 keeps the stored score finite however far now is from the epoch
+    const double elapsed = current_time_point().sec_since_epoch() - double(TREND_EPOCH);
+    const double added = elapsed / TREND_HALFLIFE + std::log2(weight);
+
+    auto itr_trending = _trending.find(account4sale.value);
+    if (itr_trending == _trending.end())
+    {
+        _trending.emplace(_self, [&](auto &s) {
+            s.account4sale = account4sale;
+            s.score = added;
+        });
+        return;
+    }
+
+    // log2(2^score + 2^added)
+    const double high = std::max(itr_trending->score, added);
+    const double low = std::min(itr_trending->score, added);
+    const double score = high + std::log2(1.0 + std::exp2(low - high));
+
+    _trending.modify(itr_trending, same_payer, [&](auto &s) {
+        s.score = score;
+    });
+}
+
+// Stamp the next change sequence on a listing
+void eosnameswaps::stamp_change(const name account4sale, const name payer)
+{
+
+    syncstate sync = _sync.get_or_default(syncstate{1, 0, 0});
+    const uint64_t seq = sync.next_seq++;
+    _sync.set(sync, _self);
+
+    auto itr_changes = _changes.find(account4sale.value);
+    if (itr_changes == _changes.end())
+    {
+        _changes.emplace(payer, [&](auto &s) {
+            s.account4sale = account4sale;
+            s.seq = seq;
+        });
+    }
+    else
+    {
+        _changes.modify(itr_changes, same_payer, [&](auto &s) {
+            s.seq = seq;
+        });
+    }
+}
+
+// Replace the change sequence of an erased listing with a tombstone
+void eosnameswaps::tombstone_change(const name account4sale)
+{
+
+    // Erase account from the changes table
+    auto itr_changes = _changes.find(account4sale.value);
+    if (itr_changes != _changes.end())
+    {
+        _changes.erase(itr_changes);
+    }
+
+    syncstate sync = _sync.get_or_default(syncstate{1, 0, 0});
+    const uint64_t seq = sync.next_seq++;
+
+    // Place data in tombstones table. Contract pays for ram storage
+    _tombstones.emplace(_self, [&](auto &s) {
+        s.seq = seq;
+        s.account4sale = account4sale;
+    });
+    sync.num_tombstones++;
+
+    // Drop the oldest tombstone once the table is full
+    if (sync.num_tombstones > MAX_TOMBSTONES)
+    {
+        auto itr_tombstones = _tombstones.begin();
+        sync.tomb_floor = itr_tombstones->seq;
+        _tombstones.erase(itr_tombstones);
+        sync.num_tombstones--;
+    }
+
+    _sync.set(sync, _self);
+}
+
+// Set the screening status of a listing and update the screening queue
+void eosnameswaps::screen_listing(const name account4sale, const uint8_t option)
+{
+
+    int screened = option;
+
+    check(screened >= 0 && screened <= 2, "Admin Error: Malformed screening data.");
+
+    // Check an account with that name is listed for sale
+    auto itr_extras = _extras.find(account4sale.value);
+    check(itr_extras != _extras.end(), "Admin Error: That account name is not listed for sale.");
+
+    // Place data in table. Contract pays for ram storage
+    _extras.modify(itr_extras, _self, [&](auto &s) {
+        upgrade_row(s);
+        s.screened = screened;
+    });
+
+    stamp_change(account4sale, _self);
+
+    // Screened listings leave the queue, unscreened listings go back to it
+    auto itr_screening = _screening.find(account4sale.value);
+    if (screened != 0 && itr_screening != _screening.end())
+    {
+        _screening.erase(itr_screening);
+    }
+    else if (screened == 0 && itr_screening == _screening.end())
+    {
+        _screening.emplace(_self, [&](auto &s) {
+            s.account4sale = account4sale;
+            s.listed = current_time_point();
+        });
+    }
+}
+
+// Current price of a listing
+asset eosnameswaps::listing_price(const name account4sale, const asset saleprice)
+{
+
+    // Fixed price listing
+    auto itr_dutch = _dutch.find(account4sale.value);
+    if (itr_dutch == _dutch.end())
+    {
+        return saleprice;
+    }
+
+    // The price falls in DUTCH_STEPS equal steps from the start to the end price
+    const int64_t decay = itr_dutch->startprice.amount - itr_dutch->endprice.amount;
+    const int64_t step_decay = static_cast<int64_t>(static_cast<__int128>(decay) * dutch_bucket(*itr_dutch) / DUTCH_STEPS);
+
+    return asset(itr_dutch->startprice.amount - step_decay, network_symbol);
+}
+
+// Current price step of a dutch auction
+uint8_t eosnameswaps::dutch_bucket(const dutchtable &auction)
+{
+
+    const uint32_t now = current_time_point().sec_since_epoch();
+    const uint32_t elapsed = now - auction.starttime.sec_since_epoch();
+
+    if (elapsed >= auction.duration)
+    {
+        return DUTCH_STEPS;
+    }
+
+    return static_cast<uint8_t>(static_cast<uint64_t>(elapsed) * DUTCH_STEPS / auction.duration);
+}
+
+// Write the current dutch auction price to the accounts and catalog tables
+void eosnameswaps::dutch_refresh(const name account4sale)
+{
+
+    auto itr_dutch = _dutch.find(account4sale.value);
+    if (itr_dutch == _dutch.end())
+    {
+        return;
+    }
+
+    // Stored prices only change once per step
+    const uint8_t bucket = dutch_bucket(*itr_dutch);
+    if (bucket == itr_dutch->decaybucket)
+    {
+        return;
+    }
+
+    auto itr_accounts = _accounts.find(account4sale.value);
+    const asset saleprice = listing_price(account4sale, itr_accounts->saleprice);
+
+    _accounts.modify(itr_accounts, same_payer, [&](auto &s) {
+        s.saleprice = saleprice;
+    });
+
+    catalog_update(account4sale, saleprice);
+
+    _dutch.modify(itr_dutch, same_payer, [&](auto &s) {
+        s.decaybucket = bucket;
+    });
+
+    stamp_change(account4sale, _self);
+}
+
+// Add listings missing from the category catalog and screening queue
+void eosnameswaps::catalogsync(name lower_bound,
+                               uint32_t max_rows)
+{
+
+    // ----------------------------------------------
+    // Auth checks
+    // ----------------------------------------------
+
+    // Only the contract account can sync the catalog
+    require_auth(_self);
+
+    // ----------------------------------------------
+
+    // Walk at most max_rows listings so each call stays within the CPU limit
+    uint32_t rows = 0;
+    for (auto itr_accounts = _accounts.lower_bound(lower_bound.value); itr_accounts != _accounts.end() && rows < max_rows; ++itr_accounts, ++rows)
+    {
+        // Dutch auctions are brought to their current price before the catalog is checked
+        dutch_refresh(itr_accounts->account4sale);
+
+        catalog_index catalog(_self, listing_category(itr_accounts->account4sale).value);
+        if (catalog.find(itr_accounts->account4sale.value) == catalog.end())
+        {
+            catalog_add(itr_accounts->account4sale, itr_accounts->saleprice, _self);
+        }
+
+        // Unscreened listings made before the queue existed go to its front
+        auto itr_extras = _extras.find(itr_accounts->account4sale.value);
+        if (itr_extras != _extras.end() && !itr_extras->screened && _screening.find(itr_accounts->account4sale.value) == _screening.end())
+        {
+            _screening.emplace(_self, [&](auto &s) {
+                s.account4sale = itr_accounts->account4sale;
+                s.listed = time_point_sec(0);
+            });
+        }
+
+        // Listings made before the change sequence existed get a stamp
+        if (_changes.find(itr_accounts->account4sale.value) == _changes.end())
+        {
+            stamp_change(itr_accounts->account4sale, _self);
+        }
+    }
 }
 
-// Action: Register Shop
-void eosnameswaps::regshop(name shopname,
-                           string title,
-                           string description,
-                           name payment1,
-                           name payment2,
-                           name payment3)
+// Action: Bring dutch auctions with no recent activity to their current price step
+void eosnameswaps::dutchsync(name lower_bound,
+                             uint32_t max_rows)
 {
 
-    // ----------------------------------------------
-    // Auth checks
-    // ----------------------------------------------
+    // No auth checks: anyone can pay the CPU to refresh prices. Rows are only modified with same_payer,
+    // and an auction already at its current step is not written
 
-    check(has_auth(_self), "Referrer Error: Only the contract account can register shops.");
+    // Walk at most DUTCH_SYNC_ROWS auctions so each call stays within the CPU limit
+    max_rows = std::min(max_rows, DUTCH_SYNC_ROWS);
 
-    // ----------------------------------------------
-    // Update table
-    // ----------------------------------------------
+    uint32_t rows = 0;
+    for (auto itr_dutch = _dutch.lower_bound(lower_bound.value); itr_dutch != _dutch.end() && rows < max_rows; ++itr_dutch, ++rows)
+    {
+        dutch_refresh(itr_dutch->account4sale);
+    }
+}
 
-    auto itr_shops = _shops.find(shopname.value);
+// Catalog scope of an account
+name eosnameswaps::listing_category(const name account)
+{
 
-    // Create new shop
-    if (itr_shops == _shops.end())
+    // Suffixed accounts are grouped by suffix
+    if (account.suffix() != account)
     {
-
-        // Place data in shoptable. Contract pays for ram storage
-        _shops.emplace(_self, [&](auto &s) {
-            s.shopname = shopname;
-            s.title = title;
-            s.description = description;
-            s.payment1 = payment1;
-            s.payment2 = payment2;
-            s.payment3 = payment3;
-        });
+        return account.suffix();
     }
-    else // Modify shop
-    {
 
-        // Place data in shoptable. Contract pays for ram storage
-        _shops.modify(itr_shops, _self, [&](auto &s) {
-            s.shopname = shopname;
-            s.title = title;
-            s.description = description;
-            s.payment1 = payment1;
-            s.payment2 = payment2;
-            s.payment3 = payment3;
-        });
-    }
+    // Other accounts are grouped by length
+    static const char *lengths[] = {"len.one", "len.two", "len.three", "len.four", "len.five", "len.six",
+                                    "len.seven", "len.eight", "len.nine", "len.ten", "len.eleven", "len.twelve"};
+
+    const int name_length = account.length();
+    check(name_length >= 1 && name_length <= 12, "Catalog Error: Invalid account name length.");
+
+    return name(lengths[name_length - 1]);
 }
 
-// Action: Propose a bid for an account
-void eosnameswaps::proposebid(name account4sale,
-                              asset bidprice,
-                              name bidder)
+// Add a listing to the category catalog
+void eosnameswaps::catalog_add(const name account4sale, const asset saleprice, const name payer)
 {
 
-    // ----------------------------------------------
-    // Auth checks
-    // ----------------------------------------------
-
-    // Confirm the bidder is who they say they are
-    check(has_auth(bidder), "Propose Bid Error: You are not who you say you are. Check permissions.");
+    const name category = listing_category(account4sale);
 
-    // ----------------------------------------------
-    // Valid transaction checks
-    // ----------------------------------------------
+    catalog_index catalog(_self, category.value);
+    catalog.emplace(payer, [&](auto &s) {
+        s.account4sale = account4sale;
+        s.saleprice = saleprice;
+    });
 
-    // Check an account with that name is listed for sale
-    auto itr_bids = _bids.find(account4sale.value);
-    check(itr_bids != _bids.end(), "Propose Bid Error: That account name is not listed for sale");
+    category_refresh(category, catalog, 1);
+}
 
-    // Check the transfer is valid
-    check(bidprice.symbol == network_symbol, (string("Propose Bid Error: Bid price must be in ") + symbol_name + string(". Ex: 10.0000 ") + symbol_name + string(".")).c_str());
-    check(bidprice.is_valid(), "Propose Bid Error: Bid price is not valid.");
-    check(bidprice >= asset(10000, network_symbol), (string("Propose Bid Error: The minimum bid price is 1.0000 ") + symbol_name + string(".")).c_str());
+// Update the price of a listing in the category catalog
+void eosnameswaps::catalog_update(const name account4sale, const asset saleprice)
+{
 
-    // Only accept new bids if they are higher
-    check(bidprice > itr_bids->bidprice, "Propose Bid Error: You must bid higher than the last bidder.");
+    const name category = listing_category(account4sale);
 
-    // Only accept new bids if they are lower than the sale price
-    auto itr_accounts = _accounts.find(account4sale.value);
-    check(bidprice <= itr_accounts->saleprice, "Propose Bid Error: You must bid lower than the sale price.");
+    catalog_index catalog(_self, category.value);
 
-    // ----------------------------------------------
-    // Update table
-    // ----------------------------------------------
+    // Listings made before the catalog existed are added by catalogsync
+    auto itr_catalog = catalog.find(account4sale.value);
+    if (itr_catalog == catalog.end())
+    {
+        return;
+    }
 
-    // Place data in bids table. Bidder pays for ram storage
-    _bids.modify(itr_bids, bidder, [&](auto &s) {
-        s.bidaccepted = 1;
-        s.bidprice = bidprice;
-        s.bidder = bidder;
+    catalog.modify(itr_catalog, same_payer, [&](auto &s) {
+        s.saleprice = saleprice;
     });
 
-    // Send message
-    send_message(itr_accounts->paymentaccnt, string("EOSNameSwaps: Your account ") + name{account4sale}.to_string() + string(" has received a bid. If you choose to accept it, the bidder can purchase the account at the lower price. Others can still bid higher or pay the full sale price until then."));
+    category_refresh(category, catalog, 0);
 }
 
-// Action: Accept or decline a bid for an account
-void eosnameswaps::decidebid(name account4sale,
-                             bool accept)
+// Erase a listing from the category catalog
+void eosnameswaps::catalog_erase(const name account4sale)
 {
 
-    // ----------------------------------------------
-    // Auth checks
-    // ----------------------------------------------
+    const name category = listing_category(account4sale);
 
-    // Check an account with that name is listed for sale
-    auto itr_accounts = _accounts.find(account4sale.value);
-    check(itr_accounts != _accounts.end(), "Decide Bid Error: That account name is not listed for sale.");
+    catalog_index catalog(_self, category.value);
 
-    // Only the payment account can accept bids
-    check(has_auth(itr_accounts->paymentaccnt), "Decide Bid Error: Only the payment account can decide on bids.");
+    // Listings made before the catalog existed are added by catalogsync
+    auto itr_catalog = catalog.find(account4sale.value);
+    if (itr_catalog == catalog.end())
+    {
+        return;
+    }
 
-    // ----------------------------------------------
-    // Valid transaction checks
-    // ----------------------------------------------
+    catalog.erase(itr_catalog);
 
-    auto itr_bids = _bids.find(account4sale.value);
+    category_refresh(category, catalog, -1);
+}
 
-    // Check there is a bid to accept or reject
-    check(itr_bids->bidprice != asset(0, network_symbol), "Decide Bid Error: There are no bids to accept or reject.");
+// Record a sale in the category summary
+void eosnameswaps::catalog_sale(const name account4sale, const asset saleprice)
+{
 
-    // ----------------------------------------------
-    // Update table
-    // ----------------------------------------------
+    auto itr_categories = _categories.find(listing_category(account4sale).value);
+    if (itr_categories == _categories.end())
+    {
+        return;
+    }
 
-    // Place data in bids table. Bidder pays for ram storage
-    if (accept == true)
+    // Sketch bucket: floor(log2) of the price in whole tokens
+    uint64_t whole_tokens = saleprice.amount;
+    for (int lp = 0; lp < network_symbol.precision(); ++lp)
     {
+        whole_tokens /= 10;
+    }
 
-        // Bid accepted
-        _bids.modify(itr_bids, itr_accounts->paymentaccnt, [&](auto &s) {
-            s.bidaccepted = 2;
-        });
+    uint8_t bucket = 0;
+    while (whole_tokens > 1 && bucket < SKETCH_BUCKETS - 1)
+    {
+        whole_tokens >>= 1;
+        bucket++;
+    }
 
-        // Send message
-        send_message(itr_bids->bidder, string("EOSNameSwaps: Your bid for ") + name{account4sale}.to_string() + string(" has been accepted. Account ") + name{itr_bids->bidder}.to_string() + string(" can buy it for the bid price. Be quick, as others can still outbid you or pay the full sale price."));
+    _categories.modify(itr_categories, _self, [&](auto &s) {
+        s.num_purchased++;
+        s.lastsale = saleprice;
+
+        s.sketch.resize(SKETCH_BUCKETS, 0);
+        s.sketch[bucket]++;
+
+        // Halve the counts once the window is full so old sales fade out
+        uint32_t total = 0;
+        for (auto count : s.sketch)
+        {
+            total += count;
+        }
+        if (total >= SKETCH_WINDOW)
+        {
+            for (auto &count : s.sketch)
+            {
+                count /= 2;
+            }
+        }
+    });
+}
+
+// Update the category summary after its catalog changed
+void eosnameswaps::category_refresh(const name category, const catalog_index &catalog, const int64_t delta_listed)
+{
+
+    // Lowest listed price from the price index
+    auto catalog_byprice = catalog.get_index<name("byprice")>();
+    const asset floorprice = catalog_byprice.begin() == catalog_byprice.end() ? asset(0, network_symbol) : catalog_byprice.begin()->saleprice;
+
+    // Update the scope directory. Contract pays for ram storage
+    auto itr_categories = _categories.find(category.value);
+    if (itr_categories == _categories.end())
+    {
+        _categories.emplace(_self, [&](auto &s) {
+            s.category = category;
+            s.num_listed = delta_listed;
+            s.floorprice = floorprice;
+            s.num_purchased = 0;
+            s.lastsale = asset(0, network_symbol);
+            s.sketch = std::vector<uint16_t>(SKETCH_BUCKETS, 0);
+        });
     }
     else
     {
-
-        // Bid rejected
-        _bids.modify(itr_bids, itr_accounts->paymentaccnt, [&](auto &s) {
-            s.bidaccepted = 0;
+        _categories.modify(itr_categories, _self, [&](auto &s) {
+            s.num_listed += delta_listed;
+            s.floorprice = floorprice;
         });
-
-        // Send message
-        send_message(itr_bids->bidder, string("EOSNameSwaps: Your bid for ") + name{account4sale}.to_string() + string(" has been rejected. Increase your bid offer"));
     }
 }
 
-// Null Action
-void eosnameswaps::null()
+// Set the contract configuration
+void eosnameswaps::setconfig(uint32_t newaccount_bytes,
+                             uint16_t newaccount_margin)
 {
 
     // ----------------------------------------------
     // Auth checks
     // ----------------------------------------------
 
-    // Only the contract can send a message
-    check(has_auth(_self), "Message Error: Only the contract can call the null action.");
-
-    // ----------------------------------------------
-}
-
-// Message Action
-void eosnameswaps::message(name receiver,
-                           string message)
-{
+    // Only the contract account can set the configuration
+    require_auth(_self);
 
     // ----------------------------------------------
-    // Auth checks
+    // Valid transaction checks
     // ----------------------------------------------
 
-    // Only the contract can send a message
-    check(has_auth(_self), "Message Error: Only the contract can send messages.");
+    check(newaccount_bytes >= 2048 && newaccount_bytes <= 65536, "Config Error: New account RAM must be between 2048 and 65536 bytes.");
+    check(newaccount_margin <= 10000, "Config Error: The new account margin must be at most 10000 basis points.");
 
     // ----------------------------------------------
 
-    // Notify the specified account
-    require_recipient(receiver);
+    // Place data in config table. Contract pays for ram storage
+    configtable config = _config.get_or_default(configtable{newaccountbytes, 0});
+    config.newaccount_bytes = newaccount_bytes;
+    config.newaccount_margin = newaccount_margin;
+    _config.set(config, _self);
 }
 
-// Action: Perform admin tasks
-void eosnameswaps::screener(name account4sale,
-                            uint8_t option)
+// Set the rate limit of an action
+void eosnameswaps::setlimit(name action,
+                            uint8_t capacity,
+                            uint32_t refill_sec)
 {
 
     // ----------------------------------------------
     // Auth checks
     // ----------------------------------------------
 
-    // Only the contract account can perform screening
+    // Only the contract account can set rate limits
     require_auth(_self);
 
     // ----------------------------------------------
-    // Set the screening status of an account listed for sale
+    // Valid transaction checks
     // ----------------------------------------------
 
-    int screened = option;
+    check(action == name("vote") || action == name("proposebid") || action == name("reserve"), "Rate Limit Error: Only vote, proposebid and reserve can be rate limited.");
+    check(capacity == 0 || refill_sec > 0, "Rate Limit Error: The refill time must be at least 1 second.");
 
-    check(screened >= 0 && screened <= 2, "Admin Error: Malformed screening data.");
+    // ----------------------------------------------
 
-    // Place data in table. Contract pays for ram storage
-    auto itr_extras = _extras.find(account4sale.value);
-    _extras.modify(itr_extras, _self, [&](auto &s) {
-        s.screened = screened;
-    });
+    configtable config = _config.get_or_default(configtable{newaccountbytes, 0});
+    if (!config.ratelimits.has_value())
+    {
+        config.ratelimits.emplace(std::vector<ratelimit>());
+    }
 
-    // ----------------------------------------------
+    // Replace the action's limit or add it
+    std::vector<ratelimit> &limits = config.ratelimits.value();
+    auto itr_limit = std::find_if(limits.begin(), limits.end(), [&](const ratelimit &l) { return l.action == action; });
+    if (itr_limit == limits.end())
+    {
+        limits.push_back(ratelimit{action, capacity, refill_sec});
+    }
+    else
+    {
+        itr_limit->capacity = capacity;
+        itr_limit->refill_sec = refill_sec;
+    }
+
+    // Place data in config table. Contract pays for ram storage
+    _config.set(config, _self);
 }
 
-// Init the stats table
-void eosnameswaps::initstats()
+// Quote the current new account fee
+asset eosnameswaps::accountquote()
+{
+    return newaccount_price();
+}
+
+// Upgrade old rows of a versioned table
+uint64_t eosnameswaps::migrate(name table,
+                               uint64_t lower_bound,
+                               uint32_t max_rows)
 {
 
     // ----------------------------------------------
     // Auth checks
     // ----------------------------------------------
 
-    // Only the contract account can init the stats table
+    // Only the contract account can migrate tables
     require_auth(_self);
 
     // ----------------------------------------------
 
-    // Init stats table
-    auto itr_stats = _stats.find(0);
-    if (itr_stats == _stats.end())
+    if (table == name("accounts"))
+    {
+        return migrate_table(_accounts, lower_bound, max_rows);
+    }
+    else if (table == name("extras"))
     {
+        return migrate_table(_extras, lower_bound, max_rows);
+    }
+    else if (table == name("bids"))
+    {
+        return migrate_table(_bids, lower_bound, max_rows);
+    }
+    else if (table == name("stats"))
+    {
+        return migrate_table(_stats, lower_bound, max_rows);
+    }
 
-        for (int index = 0; index <= 5; index++)
+    check(false, "Migrate Error: That table is not versioned.");
+    return 0;
+}
+
+// Upgrade at most max_rows rows from lower_bound
+template <typename Table>
+uint64_t eosnameswaps::migrate_table(Table &table, const uint64_t lower_bound, const uint32_t max_rows)
+{
+
+    auto itr = table.lower_bound(lower_bound);
+    for (uint32_t rows = 0; itr != table.end() && rows < max_rows; ++itr, ++rows)
+    {
+        if (itr->version.has_value() && itr->version.value() >= ROW_VERSION)
         {
-            _stats.emplace(_self, [&](auto &s) {
-                s.index = index;
-                s.num_listed = 0;
-                s.num_purchased = 0;
-                s.tot_sales = asset(0, network_symbol);
-                s.tot_fees = asset(0, network_symbol);
-            });
+            continue;
         }
+
+        // The seller may not have authorized this action, so the contract pays for the larger row
+        table.modify(itr, _self, [&](auto &s) {
+            upgrade_row(s);
+        });
     }
+
+    // Key to continue from, or UINT64_MAX once the table is done
+    return itr == table.end() ? UINT64_MAX : itr->primary_key();
 }
 
 // Broadcast message
@@ -1027,61 +2731,104 @@ extern "C"
     void apply(uint64_t receiver, uint64_t code, uint64_t action)
     {
 
+#ifdef EOSNAMESWAPS_TRACE
+        eosnameswaps_trace::dispatch(receiver, code, action);
+#endif
+
         if (code == name("eosio.token").value && action == name("transfer").value)
         {
             execute_action(name(receiver), name(code), &eosnameswaps::buy);
         }
-        else if (code == receiver && action == name("null").value)
-        {
-            execute_action(name(receiver), name(code), &eosnameswaps::null);
-        }
-        else if (code == receiver && action == name("sell").value)
-        {
-            execute_action(name(receiver), name(code), &eosnameswaps::sell);
-        }
-        else if (code == receiver && action == name("cancel").value)
-        {
-            execute_action(name(receiver), name(code), &eosnameswaps::cancel);
-        }
-        else if (code == receiver && action == name("remove").value)
-        {
-            execute_action(name(receiver), name(code), &eosnameswaps::remove);
-        }
-        else if (code == receiver && action == name("update").value)
-        {
-            execute_action(name(receiver), name(code), &eosnameswaps::update);
-        }
-        else if (code == receiver && action == name("vote").value)
+        else if (code == receiver)
         {
-            execute_action(name(receiver), name(code), &eosnameswaps::vote);
-        }
-        else if (code == receiver && action == name("proposebid").value)
-        {
-            execute_action(name(receiver), name(code), &eosnameswaps::proposebid);
-        }
-        else if (code == receiver && action == name("decidebid").value)
-        {
-            execute_action(name(receiver), name(code), &eosnameswaps::decidebid);
-        }
-        else if (code == receiver && action == name("message").value)
-        {
-            execute_action(name(receiver), name(code), &eosnameswaps::message);
-        }
-        else if (code == receiver && action == name("screener").value)
-        {
-            execute_action(name(receiver), name(code), &eosnameswaps::screener);
-        }
-        else if (code == receiver && action == name("regref").value)
-        {
-            execute_action(name(receiver), name(code), &eosnameswaps::regref);
-        }
-        else if (code == receiver && action == name("regshop").value)
-        {
-            execute_action(name(receiver), name(code), &eosnameswaps::regshop);
-        }
-        else if (code == receiver && action == name("initstats").value)
-        {
-            execute_action(name(receiver), name(code), &eosnameswaps::initstats);
+            // Case labels are name values folded at compile time, so this compiles to a jump table or binary search
+            switch (action)
+            {
+            case name("null").value:
+                execute_action(name(receiver), name(code), &eosnameswaps::null);
+                break;
+            case name("sell").value:
+                execute_action(name(receiver), name(code), &eosnameswaps::sell);
+                break;
+            case name("cancel").value:
+                execute_action(name(receiver), name(code), &eosnameswaps::cancel);
+                break;
+            case name("remove").value:
+                execute_action(name(receiver), name(code), &eosnameswaps::remove);
+                break;
+            case name("update").value:
+                execute_action(name(receiver), name(code), &eosnameswaps::update);
+                break;
+            case name("dutch").value:
+                execute_action(name(receiver), name(code), &eosnameswaps::dutch);
+                break;
+            case name("bulkmake").value:
+                execute_action(name(receiver), name(code), &eosnameswaps::bulkmake);
+                break;
+            case name("withdraw").value:
+                execute_action(name(receiver), name(code), &eosnameswaps::withdraw);
+                break;
+            case name("cancelwant").value:
+                execute_action(name(receiver), name(code), &eosnameswaps::cancelwant);
+                break;
+            case name("vote").value:
+                execute_action(name(receiver), name(code), &eosnameswaps::vote);
+                break;
+            case name("setsplits").value:
+                execute_action(name(receiver), name(code), &eosnameswaps::setsplits);
+                break;
+            case name("setshop").value:
+                execute_action(name(receiver), name(code), &eosnameswaps::setshop);
+                break;
+            case name("proposebid").value:
+                execute_action(name(receiver), name(code), &eosnameswaps::proposebid);
+                break;
+            case name("decidebid").value:
+                execute_action(name(receiver), name(code), &eosnameswaps::decidebid);
+                break;
+            case name("reserve").value:
+                execute_action(name(receiver), name(code), &eosnameswaps::reserve);
+                break;
+            case name("message").value:
+                execute_action(name(receiver), name(code), &eosnameswaps::message);
+                break;
+            case name("screener").value:
+                execute_action(name(receiver), name(code), &eosnameswaps::screener);
+                break;
+            case name("screenbatch").value:
+                execute_action(name(receiver), name(code), &eosnameswaps::screenbatch);
+                break;
+            case name("regref").value:
+                execute_action(name(receiver), name(code), &eosnameswaps::regref);
+                break;
+            case name("regshop").value:
+                execute_action(name(receiver), name(code), &eosnameswaps::regshop);
+                break;
+            case name("initstats").value:
+                execute_action(name(receiver), name(code), &eosnameswaps::initstats);
+                break;
+            case name("migrate").value:
+                execute_action(name(receiver), name(code), &eosnameswaps::migrate);
+                break;
+            case name("setconfig").value:
+                execute_action(name(receiver), name(code), &eosnameswaps::setconfig);
+                break;
+            case name("setlimit").value:
+                execute_action(name(receiver), name(code), &eosnameswaps::setlimit);
+                break;
+            case name("accountquote").value:
+                execute_action(name(receiver), name(code), &eosnameswaps::accountquote);
+                break;
+            case name("quote").value:
+                execute_action(name(receiver), name(code), &eosnameswaps::quote);
+                break;
+            case name("catalogsync").value:
+                execute_action(name(receiver), name(code), &eosnameswaps::catalogsync);
+                break;
+            case name("dutchsync").value:
+                execute_action(name(receiver), name(code), &eosnameswaps::dutchsync);
+                break;
+            }
         }
         eosio_exit(0);
     }